@@ -0,0 +1,691 @@
+//====================================================================================================
+// Filename:	CoreBench.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+// Times the xcore hot paths on their own, no engine and no window. Every section also checks its
+// results, so a non zero exit code means something is broken rather than slow.
+//
+//   CoreBench [imageDirectory]
+
+#include "Precompiled.h"
+#include "Clock.h"
+#include "Config.h"
+#include "Fence.h"
+#include "FrameAllocator.h"
+#include "JobSystem.h"
+#include "PngCodec.h"
+#include "RadixSort.h"
+#include "Timer.h"
+#include "XMath.h"
+#include "XRandom.h"
+
+#include <filesystem>
+
+using namespace X;
+
+namespace
+{
+	using SteadyClock = std::chrono::steady_clock;
+
+	double ToMilliseconds(SteadyClock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	bool BenchMath()
+	{
+		constexpr int kCount = 1000000;
+
+		const Math::Matrix4 step = Math::Matrix4::RotationY(0.001f) * Math::Matrix4::Translation(0.5f, 0.0f, 0.25f);
+		Math::Matrix4 world = Math::Matrix4::Identity();
+		Math::Vector3 sum;
+
+		const SteadyClock::time_point start = SteadyClock::now();
+		for (int i = 0; i < kCount; ++i)
+		{
+			world = world * step;
+			sum = sum + Math::TransformCoord(Math::Vector3(1.0f, 2.0f, 3.0f), world);
+		}
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+
+		printf("math: %d matrix multiplies and transforms in %.3f ms\n", kCount, elapsed);
+		return std::isfinite(sum.x) && std::isfinite(sum.y) && std::isfinite(sum.z);
+	}
+
+	bool NearlyEqual(float a, float b)
+	{
+		return Math::Abs(a - b) <= 1e-4f * (1.0f + Math::Abs(a) + Math::Abs(b));
+	}
+
+	bool BenchBatchTransform()
+	{
+		constexpr uint32_t kCount = 1 << 16;
+		constexpr int kPasses = 64;
+
+		const Math::Matrix4 world = Math::Matrix4::Scaling(2.0f) * Math::Matrix4::RotationY(0.7f) * Math::Matrix4::RotationX(-0.3f) * Math::Matrix4::Translation(5.0f, -3.0f, 1.5f);
+		const Math::Matrix3 world2D = Math::Matrix3::Rotation(0.4f) * Math::Matrix3::Translation(10.0f, 20.0f);
+
+		std::vector<Math::Vector3> points(kCount);
+		std::vector<Math::Vector2> points2D(kCount + 1);
+		for (uint32_t i = 0; i < kCount; ++i)
+		{
+			points[i] = Math::Vector3((float)(i % 97), (float)(i % 31) - 15.0f, (float)(i % 7) * 0.5f);
+			points2D[i] = Math::Vector2(points[i].x, points[i].y);
+		}
+		points2D[kCount] = Math::Vector2(-4.0f, 9.0f);
+
+		// Results against the plain row vector math, the odd Vector2 count covers the scalar tail
+		bool passed = true;
+		for (uint32_t i = 0; i < kCount && passed; ++i)
+		{
+			const Math::Vector3& v = points[i];
+			const Math::Vector3 p = Math::TransformCoord(v, world);
+			passed &= NearlyEqual(p.x, v.x * world._11 + v.y * world._21 + v.z * world._31 + world._41);
+			passed &= NearlyEqual(p.y, v.x * world._12 + v.y * world._22 + v.z * world._32 + world._42);
+			passed &= NearlyEqual(p.z, v.x * world._13 + v.y * world._23 + v.z * world._33 + world._43);
+			const Math::Vector3 n = Math::TransformNormal(v, world);
+			passed &= NearlyEqual(n.x, v.x * world._11 + v.y * world._21 + v.z * world._31);
+			passed &= NearlyEqual(n.z, v.x * world._13 + v.y * world._23 + v.z * world._33);
+		}
+
+		std::vector<Math::Vector2> out2D(points2D);
+		Math::TransformCoord(out2D.data(), out2D.data(), kCount + 1, world2D);
+		for (uint32_t i = 0; i <= kCount && passed; ++i)
+		{
+			const Math::Vector2& v = points2D[i];
+			passed &= NearlyEqual(out2D[i].x, v.x * world2D._11 + v.y * world2D._21 + world2D._31);
+			passed &= NearlyEqual(out2D[i].y, v.x * world2D._12 + v.y * world2D._22 + world2D._32);
+		}
+
+		// The affine inverse has to undo the transform, the general one still has to handle projections
+		const Math::Matrix4 identity = world * Math::Inverse(world);
+		const Math::Matrix4 proj = Math::Matrix4::Translation(1.0f, 2.0f, 3.0f) * Math::Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.5f, 0.0f, 0.0f, -1.0f, 1.0f);
+		const Math::Matrix4 projIdentity = proj * Math::Inverse(proj);
+		const float* a = &identity._11;
+		const float* b = &projIdentity._11;
+		for (int i = 0; i < 16; ++i)
+		{
+			const float expected = (i % 5 == 0) ? 1.0f : 0.0f;
+			passed &= NearlyEqual(a[i], expected) && NearlyEqual(b[i], expected);
+		}
+
+		// Timed in place so every pass depends on the last one
+		std::vector<Math::Vector3> out(points);
+		SteadyClock::time_point start = SteadyClock::now();
+		for (int pass = 0; pass < kPasses; ++pass)
+		{
+			for (uint32_t i = 0; i < kCount; ++i)
+			{
+				out[i] = Math::TransformCoord(out[i], world);
+			}
+		}
+		const double single = ToMilliseconds(SteadyClock::now() - start);
+		passed &= std::isfinite(out[kCount - 1].x);
+
+		out2D = points2D;
+		start = SteadyClock::now();
+		for (int pass = 0; pass < kPasses; ++pass)
+		{
+			Math::TransformCoord(out2D.data(), out2D.data(), kCount, world2D);
+		}
+		const double batch2D = ToMilliseconds(SteadyClock::now() - start);
+
+		printf("transform: %u points x %d, single %.3f ms, batch 2D %.3f ms\n", kCount, kPasses, single, batch2D);
+		return passed;
+	}
+
+	bool BenchBatchIntersect()
+	{
+		constexpr uint32_t kCount = 4099;
+		constexpr int kPasses = 256;
+
+		uint32_t state = 12345u;
+		auto random = [&state](float range)
+		{
+			state = state * 1664525u + 1013904223u;
+			return (float)(state >> 8) / (float)(1 << 24) * range;
+		};
+
+		std::vector<Math::Rect> rects(kCount);
+		std::vector<Math::Circle> circles(kCount);
+		std::vector<Math::LineSegment> segments(kCount);
+		for (uint32_t i = 0; i < kCount; ++i)
+		{
+			const float x = random(1000.0f);
+			const float y = random(1000.0f);
+			rects[i] = Math::Rect(x, y, x + 1.0f + random(60.0f), y + 1.0f + random(60.0f));
+			circles[i] = Math::Circle(random(1000.0f), random(1000.0f), 1.0f + random(40.0f));
+			segments[i] = Math::LineSegment(x, y, x + 1.0f + random(100.0f), y - 50.0f + random(100.0f));
+		}
+		segments[7] = segments[3];
+
+		const Math::Rect rectProbe(400.0f, 400.0f, 560.0f, 520.0f);
+		const Math::Circle circleProbe(500.0f, 480.0f, 90.0f);
+		const Math::LineSegment segmentProbe = segments[3];
+
+		// Every bit has to agree with the single pair test
+		std::vector<uint32_t> hitMask((kCount + 31) / 32);
+		auto check = [&hitMask](uint32_t hits, auto&& expected)
+		{
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < kCount; ++i)
+			{
+				const bool bit = (hitMask[i / 32] & (1u << (i % 32))) != 0;
+				if (bit != expected(i))
+				{
+					printf("intersect: candidate %u does not match the scalar test\n", i);
+					return false;
+				}
+				count += bit ? 1 : 0;
+			}
+			return count == hits && count > 0;
+		};
+
+		bool passed = true;
+		passed &= check(Math::Intersect(rectProbe, rects.data(), kCount, hitMask.data()), [&](uint32_t i) { return Math::Intersect(rectProbe, rects[i]); });
+		passed &= check(Math::Intersect(circleProbe, circles.data(), kCount, hitMask.data()), [&](uint32_t i) { return Math::Intersect(circleProbe, circles[i]); });
+		passed &= check(Math::Intersect(circleProbe, rects.data(), kCount, hitMask.data()), [&](uint32_t i) { return Math::Intersect(circleProbe, rects[i]); });
+		passed &= check(Math::Intersect(circleProbe, segments.data(), kCount, hitMask.data()), [&](uint32_t i) { return Math::Intersect(circleProbe, segments[i]); });
+		passed &= check(Math::Intersect(segmentProbe, segments.data(), kCount, hitMask.data()), [&](uint32_t i) { return Math::Intersect(segmentProbe, segments[i]); });
+
+		uint32_t singleHits = 0;
+		SteadyClock::time_point start = SteadyClock::now();
+		for (int pass = 0; pass < kPasses; ++pass)
+		{
+			for (uint32_t i = 0; i < kCount; ++i)
+			{
+				singleHits += Math::Intersect(circleProbe, rects[i]) ? 1 : 0;
+			}
+		}
+		const double single = ToMilliseconds(SteadyClock::now() - start);
+
+		uint32_t batchHits = 0;
+		start = SteadyClock::now();
+		for (int pass = 0; pass < kPasses; ++pass)
+		{
+			batchHits += Math::Intersect(circleProbe, rects.data(), kCount, hitMask.data());
+		}
+		const double batch = ToMilliseconds(SteadyClock::now() - start);
+
+		printf("intersect: circle vs %u rects x %d, single %.3f ms, batch %.3f ms\n", kCount, kPasses, single, batch);
+		return passed && singleHits == batchHits;
+	}
+
+	bool BenchRandom()
+	{
+		constexpr size_t kCount = 1 << 22;
+
+		// Reference output of the PCG32 demo, seed 42 on stream 54
+		const uint32_t kExpected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+		RandomStream stream(42, 54);
+		bool passed = true;
+		for (uint32_t expected : kExpected)
+		{
+			passed &= stream.Next() == expected;
+		}
+
+		// Jumping ahead lands where stepping does, bulk fills match single draws
+		RandomStream stepped(7, 3);
+		RandomStream jumped(7, 3);
+		for (int i = 0; i < 1000; ++i)
+		{
+			stepped.Next();
+		}
+		jumped.Advance(1000);
+		passed &= stepped.Next() == jumped.Next();
+
+		std::vector<uint32_t> values(kCount);
+		RandomStream single(99);
+		RandomStream bulk(99);
+		const SteadyClock::time_point start = SteadyClock::now();
+		bulk.Fill(values.data(), values.size());
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+		for (size_t i = 0; i < 1024; ++i)
+		{
+			passed &= values[i] == single.Next();
+		}
+
+		// Streams of one seed must not just be offsets of each other
+		RandomStream a(5, 0);
+		RandomStream b(5, 1);
+		int matches = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			matches += a.Next() == b.Next() ? 1 : 0;
+		}
+		passed &= matches == 0;
+
+		int histogram[6] = {};
+		for (int i = 0; i < 60000; ++i)
+		{
+			const int value = single.Range(-2, 3);
+			passed &= value >= -2 && value <= 3;
+			const float f = single.Range(1.0f, 2.0f);
+			passed &= f >= 1.0f && f < 2.0f;
+			++histogram[(value + 2) % 6];
+		}
+		for (int count : histogram)
+		{
+			passed &= count > 9000 && count < 11000;
+		}
+
+		std::mt19937 engine(99);
+		uint32_t sum = 0;
+		const SteadyClock::time_point mtStart = SteadyClock::now();
+		for (size_t i = 0; i < kCount; ++i)
+		{
+			sum += engine();
+		}
+		const double mtElapsed = ToMilliseconds(SteadyClock::now() - mtStart);
+
+		printf("random: %zu values in %.3f ms, mt19937 %.3f ms (%u)\n", kCount, elapsed, mtElapsed, sum & 1);
+		return passed;
+	}
+
+	bool BenchRadixSort()
+	{
+		constexpr size_t kCount = 1 << 20;
+
+		std::vector<uint64_t> keys(kCount);
+		std::vector<uint64_t> scratch(kCount);
+		uint64_t state = 0x9e3779b97f4a7c15ull;
+		for (uint64_t& key : keys)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			key = state;
+		}
+
+		const SteadyClock::time_point start = SteadyClock::now();
+		RadixSort(keys.data(), scratch.data(), keys.size());
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+
+		printf("radix sort: %zu keys in %.3f ms\n", kCount, elapsed);
+		return std::is_sorted(keys.begin(), keys.end());
+	}
+
+	bool BenchFrameAllocator()
+	{
+		struct Command
+		{
+			uint32_t id;
+			float x, y;
+		};
+		constexpr int kFrames = 200;
+		constexpr uint32_t kCommands = 20000;
+
+		// Starts far too small so the first frames overflow and the arenas have to grow
+		FrameAllocator allocator;
+		allocator.Initialize(1024);
+		FrameVector<Command> commands(allocator);
+		const Command* previous = nullptr;
+		size_t previousCount = 0;
+		size_t settledCapacity = 0;
+		bool passed = true;
+
+		const SteadyClock::time_point start = SteadyClock::now();
+		for (int frame = 0; frame < kFrames; ++frame)
+		{
+			for (uint32_t i = 0; i < kCommands; ++i)
+			{
+				commands.emplace_back(frame * kCommands + i, static_cast<float>(i), 1.0f);
+			}
+			double* aligned = allocator.Allocate<double>(3);
+			passed &= reinterpret_cast<uintptr_t>(aligned) % alignof(double) == 0;
+
+			// Last frame's commands are still intact while this frame records
+			for (size_t i = 0; i < previousCount; i += 997)
+			{
+				passed &= previous[i].id == (frame - 1) * kCommands + i;
+			}
+			previous = commands.data();
+			previousCount = commands.size();
+
+			commands.clear();
+			allocator.Flip();
+			if (frame == kFrames / 2)
+			{
+				settledCapacity = allocator.GetCapacity();
+			}
+		}
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+
+		// Same workload every frame, so the arenas stop growing after the first few
+		passed &= allocator.GetCapacity() == settledCapacity;
+		printf("frame allocator: %d frames of %u commands in %.3f ms, %zu KB per arena\n", kFrames, kCommands, elapsed, allocator.GetCapacity() / 2048);
+		allocator.Terminate();
+		return passed;
+	}
+
+	bool BenchFence()
+	{
+		constexpr uint32_t kFrames = 20000;
+
+		// Same hand off as the game and render threads, each side waits for the other's last frame
+		Fence submitted;
+		Fence rendered;
+		uint32_t frameData[2] = {};
+		bool passed = true;
+
+		const SteadyClock::time_point start = SteadyClock::now();
+		std::thread renderer([&]()
+		{
+			for (uint32_t frame = 1; frame <= kFrames; ++frame)
+			{
+				submitted.Wait(frame);
+				passed &= frameData[frame & 1] == frame;
+				rendered.Signal(frame);
+			}
+		});
+		for (uint32_t frame = 1; frame <= kFrames; ++frame)
+		{
+			rendered.Wait(frame - 1);
+			frameData[frame & 1] = frame;
+			submitted.Signal(frame);
+		}
+		renderer.join();
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+
+		passed &= rendered.IsComplete(kFrames) && !rendered.IsComplete(kFrames + 1);
+		printf("fence: %u frame hand offs in %.3f ms\n", kFrames, elapsed);
+		return passed;
+	}
+
+	bool BenchJobSystem()
+	{
+		constexpr uint32_t kCount = 1 << 22;
+		constexpr uint32_t kJobs = 5000;
+
+		JobSystem jobs;
+		jobs.Initialize(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		bool passed = true;
+
+		std::vector<uint32_t> values(kCount);
+		for (uint32_t i = 0; i < kCount; ++i)
+		{
+			values[i] = i * 2654435761u;
+		}
+		uint64_t expected = 0;
+		const SteadyClock::time_point serialStart = SteadyClock::now();
+		for (const uint32_t value : values)
+		{
+			expected += value % 1000;
+		}
+		const double serialTime = ToMilliseconds(SteadyClock::now() - serialStart);
+
+		// Parallel sum, each slice adds its partial into a shared total
+		struct Sum
+		{
+			const uint32_t* values;
+			std::atomic<uint64_t> total{ 0 };
+		} sum;
+		sum.values = values.data();
+		const SteadyClock::time_point parallelStart = SteadyClock::now();
+		jobs.ParallelFor(kCount, 4096, [](void* data, uint32_t begin, uint32_t end)
+		{
+			Sum& sum = *static_cast<Sum*>(data);
+			uint64_t partial = 0;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				partial += sum.values[i] % 1000;
+			}
+			sum.total += partial;
+		}, &sum);
+		const double parallelTime = ToMilliseconds(SteadyClock::now() - parallelStart);
+		passed &= sum.total.load() == expected;
+
+		// Many tiny loops, the counter on ParallelFor's stack goes away as soon as it reads done
+		std::atomic<uint32_t> items{ 0 };
+		for (uint32_t i = 0; i < 20000; ++i)
+		{
+			jobs.ParallelFor(8, 1, [](void* data, uint32_t begin, uint32_t end)
+			{
+				static_cast<std::atomic<uint32_t>*>(data)->fetch_add(end - begin);
+			}, &items);
+		}
+		passed &= items.load() == 20000 * 8;
+
+		// One counter reused for jobs scheduled one at a time, a job can finish while the next is being
+		// added. Every Wait has to see both jobs of its round done.
+		std::atomic<uint32_t> runs{ 0 };
+		JobCounter reused;
+		for (uint32_t i = 0; i < 20000 && passed; ++i)
+		{
+			jobs.Run([](void* data) { static_cast<std::atomic<uint32_t>*>(data)->fetch_add(1); }, &runs, reused);
+			jobs.Run([](void* data) { static_cast<std::atomic<uint32_t>*>(data)->fetch_add(1); }, &runs, reused);
+			jobs.Wait(reused);
+			passed &= runs.load() == (i + 1) * 2;
+		}
+
+		// More jobs in flight than a thread has slots for, each running after the first batch
+		std::atomic<uint32_t> done{ 0 };
+		JobCounter first;
+		JobCounter second;
+		for (uint32_t i = 0; i < kJobs; ++i)
+		{
+			jobs.Run([](void* data) { static_cast<std::atomic<uint32_t>*>(data)->fetch_add(1); }, &done, first);
+		}
+		jobs.RunAfter(first, [](void* data)
+		{
+			std::atomic<uint32_t>& done = *static_cast<std::atomic<uint32_t>*>(data);
+			done = done == kJobs ? ~0u : 0u;
+		}, &done, second);
+		jobs.Wait(second);
+		passed &= done.load() == ~0u && first.IsDone();
+
+		printf("job system: %u workers, sum of %u in %.3f ms (serial %.3f ms), %u jobs\n", jobs.GetWorkerCount(), kCount, parallelTime, serialTime, kJobs);
+		jobs.Terminate();
+		return passed;
+	}
+
+	bool BenchPng(const char* imageDirectory)
+	{
+		// Round trip a generated image through the encoder
+		Image source;
+		source.width = 512;
+		source.height = 512;
+		source.pixels.resize(source.width * source.height * 4);
+		for (size_t i = 0; i < source.pixels.size(); ++i)
+		{
+			source.pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 11));
+		}
+
+		std::vector<uint8_t> encoded;
+		EncodePng(source, encoded);
+		Image decoded;
+		if (!DecodePng(encoded.data(), encoded.size(), decoded) || decoded.pixels != source.pixels)
+		{
+			printf("png: round trip failed\n");
+			return false;
+		}
+
+		// Decode every PNG in the asset directory
+		std::error_code error;
+		std::filesystem::directory_iterator iterator(imageDirectory, error);
+		if (error)
+		{
+			printf("png: %s not found, skipping assets\n", imageDirectory);
+			return true;
+		}
+
+		int count = 0;
+		size_t pixels = 0;
+		double elapsed = 0.0;
+		for (const std::filesystem::directory_entry& entry : iterator)
+		{
+			const std::string path = entry.path().string();
+			if (Platform::CompareNoCase(entry.path().extension().string().c_str(), ".png") != 0)
+			{
+				continue;
+			}
+
+			Image image;
+			const SteadyClock::time_point start = SteadyClock::now();
+			const bool loaded = LoadPng(path.c_str(), image);
+			elapsed += ToMilliseconds(SteadyClock::now() - start);
+			if (!loaded)
+			{
+				printf("png: failed to decode %s\n", path.c_str());
+				return false;
+			}
+			++count;
+			pixels += image.pixels.size() / 4;
+		}
+
+		printf("png: decoded %d files, %zu pixels in %.3f ms\n", count, pixels, elapsed);
+		return true;
+	}
+
+	bool WriteText(const char* fileName, const char* text)
+	{
+		FILE* file = Platform::OpenFile(fileName, "wb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		fputs(text, file);
+		fclose(file);
+		return true;
+	}
+
+	bool BenchConfig()
+	{
+		constexpr int kCount = 1000000;
+
+		const std::string fileName = (std::filesystem::temp_directory_path() / "CoreBench.json").string();
+		if (!WriteText(fileName.c_str(), "{ \"Speed\": 100, \"Name\": \"first\" }"))
+		{
+			printf("config: failed to write %s\n", fileName.c_str());
+			return false;
+		}
+
+		Config config;
+		config.Load(fileName.c_str());
+		const ConfigFloat speed = config.FindFloat("Speed", 1.0f);
+		const char* name = config.GetString("Name");
+
+		float sum = 0.0f;
+		SteadyClock::time_point start = SteadyClock::now();
+		for (int i = 0; i < kCount; ++i)
+		{
+			sum += config.GetFloat("Missing", 1.0f);
+		}
+		const double lookupTime = ToMilliseconds(SteadyClock::now() - start);
+
+		start = SteadyClock::now();
+		for (int i = 0; i < kCount; ++i)
+		{
+			sum += speed.Get();
+		}
+		const double handleTime = ToMilliseconds(SteadyClock::now() - start);
+
+		// Rewrite the file and let the watcher swap it in
+		WriteText(fileName.c_str(), "{ \"Speed\": 250.5, \"Name\": \"second\" }");
+		config.SetHotReload(true);
+		config.Update();
+		std::remove(fileName.c_str());
+
+		printf("config: %d lookups by name in %.3f ms, by handle in %.3f ms\n", kCount, lookupTime, handleTime);
+		return sum > 0.0f && speed.Get() == 250.5f && strcmp(config.GetString("Name"), "second") == 0 && strcmp(name, "first") == 0;
+	}
+
+	bool BenchManualClock()
+	{
+		constexpr int kFrames = 100000;
+
+		ManualClock clock;
+		Timer timer;
+		timer.SetClock(&clock);
+		timer.SetTimeScale(20.0f);
+		timer.Initialize();
+
+		// A simulated 20x fast forward over half an hour of 60 Hz frames, without waiting on anything
+		const SteadyClock::time_point start = SteadyClock::now();
+		for (int i = 0; i < kFrames; ++i)
+		{
+			clock.Advance(1.0f / 60.0f);
+			timer.Update();
+		}
+		const double elapsed = ToMilliseconds(SteadyClock::now() - start);
+
+		printf("manual clock: %d frames, %.1f s of game time in %.3f ms\n", kFrames, timer.GetTotalTime(), elapsed);
+		return Math::Abs(timer.GetElapsedTime() - 20.0f / 60.0f) < 1e-4f
+			&& Math::Abs(timer.GetUnscaledElapsedTime() - 1.0f / 60.0f) < 1e-5f;
+	}
+
+	bool BenchFixedStepHitch()
+	{
+		constexpr int kFrames = 60;
+		constexpr int kSlowFrame = 40;
+
+		ManualClock clock;
+		Timer timer;
+		timer.SetClock(&clock);
+		timer.Initialize();
+
+		// Game time moves a fixed step every frame while one frame really takes much longer
+		for (int i = 0; i < kFrames; ++i)
+		{
+			clock.Advance(1.0f / 60.0f);
+			std::this_thread::sleep_for(std::chrono::milliseconds(i == kSlowFrame ? 40 : 1));
+			timer.Update();
+		}
+
+		printf("fixed step hitch: max %.1f ms, p50 %.1f ms, %u hitches\n", timer.GetMaxFrameTime(), timer.GetFrameTimePercentile(0.5f), timer.GetHitchCount());
+		return Math::Abs(timer.GetUnscaledElapsedTime() - 1.0f / 60.0f) < 1e-5f
+			&& timer.GetMaxFrameTime() >= 40.0f
+			&& timer.GetHitchCount() >= 1;
+	}
+
+	bool BenchFrameLimiter()
+	{
+		constexpr float kFrameRate = 240.0f;
+		constexpr int kFrames = 120;
+
+		Timer timer;
+		timer.SetTargetFrameRate(kFrameRate);
+		timer.Initialize();
+
+		// Jitter is how far each frame lands from the target frame time
+		const float target = 1000.0f / kFrameRate;
+		float total = 0.0f;
+		float jitter = 0.0f;
+		for (int i = 0; i < kFrames; ++i)
+		{
+			timer.WaitForNextFrame();
+			timer.Update();
+			const float frameTime = timer.GetElapsedTime() * 1000.0f;
+			total += frameTime;
+			jitter = Math::Max(jitter, Math::Abs(frameTime - target));
+		}
+
+		const float average = total / kFrames;
+		printf("frame limiter: %.3f ms target, %.3f ms average, p99 %.1f ms, max jitter %.3f ms, %u hitches\n", target, average, timer.GetFrameTimePercentile(0.99f), jitter, timer.GetHitchCount());
+
+		// Only the average is checked, a loaded machine can always wake us up late
+		return Math::Abs(average - target) < target * 0.05f;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* imageDirectory = argc > 1 ? argv[1] : "../Assets/Images";
+
+	bool passed = true;
+	passed &= BenchMath();
+	passed &= BenchBatchTransform();
+	passed &= BenchBatchIntersect();
+	passed &= BenchRandom();
+	passed &= BenchRadixSort();
+	passed &= BenchFrameAllocator();
+	passed &= BenchFence();
+	passed &= BenchJobSystem();
+	passed &= BenchPng(imageDirectory);
+	passed &= BenchConfig();
+	passed &= BenchManualClock();
+	passed &= BenchFixedStepHitch();
+	passed &= BenchFrameLimiter();
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+//====================================================================================================
+// Filename:	DrawBench.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+// Draws overlapping sprites from X::ParallelFor with different worker thread counts and checks every
+// run saves the same frame, i.e. the sprites were submitted in the same order however the slices were
+// scheduled. Must be run from the Pacman directory so ../Assets is found.
+//
+//   DrawBench [sprites]
+
+#include <XEngine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t kWorkerCounts[] = { 0, 1, 3, 7 };
+
+	uint32_t sSpriteCount = 4096;
+	X::TextureId sTextures[2] = {};
+	std::string sFrameFile;
+	uint64_t sFrame = 0;
+	double sDrawTime = 0.0;
+
+	bool DrawLoop(float deltaTime)
+	{
+		// A few sprites straight from the game thread, under the ones from the jobs
+		X::SetSpriteLayer(1);
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			X::DrawSprite(sTextures[0], X::Math::Vector2(40.0f + i * 8.0f, 40.0f));
+		}
+
+		// Neighbours overlap and share a texture, so any change in order shows in the frame
+		const auto start = std::chrono::steady_clock::now();
+		X::ParallelFor(sSpriteCount, 16, [](uint32_t begin, uint32_t end)
+		{
+			// Give workers a chance to take slices even on a single core
+			std::this_thread::yield();
+			X::SetSpriteLayer(static_cast<uint8_t>(begin % 3));
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const X::Math::Vector2 position(static_cast<float>((i * 7) % 600), static_cast<float>((i * 13) % 400));
+				if (i % 5 == 0)
+				{
+					X::DrawSprite(sTextures[1], X::Math::Rect{ 0.0f, 0.0f, 24.0f, 24.0f }, position);
+				}
+				else
+				{
+					X::DrawSprite(sTextures[i % 2], position, static_cast<float>(i % 4) * 0.5f);
+				}
+			}
+		});
+		sDrawTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (sFrame == 0)
+		{
+			X::SaveFrame(sFrameFile.c_str());
+		}
+		return ++sFrame > 1;
+	}
+
+	bool ReadFile(const std::string& fileName, std::vector<char>& bytes)
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return !bytes.empty();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		sSpriteCount = std::max(1ul, std::strtoul(argv[1], nullptr, 10));
+	}
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	std::vector<char> reference;
+	bool passed = true;
+	for (const uint32_t workers : kWorkerCounts)
+	{
+		const std::string configFile = (directory / ("DrawBench" + std::to_string(workers) + ".json")).string();
+		std::ofstream(configFile) << "{ \"AppName\": \"DrawBench\", \"WorkerThreads\": " << workers << " }\n";
+		sFrameFile = (directory / ("DrawBench" + std::to_string(workers) + ".png")).string();
+		sFrame = 0;
+		sDrawTime = 0.0;
+
+		X::Start(configFile.c_str());
+		sTextures[0] = X::LoadTexture("Pacman1.png");
+		sTextures[1] = X::LoadTexture("Pac_sheet.png");
+		X::Run(DrawLoop);
+		const uint32_t spriteCommands = X::GetFrameStats().spriteCommands;
+		X::Stop();
+
+		std::vector<char> frame;
+		const bool saved = ReadFile(sFrameFile, frame);
+		if (reference.empty())
+		{
+			reference = frame;
+		}
+		const bool matches = saved && frame == reference;
+		passed &= matches;
+		printf("draw: %u workers, %u sprites, %.3f ms/frame, frame %s\n", workers, spriteCommands, sDrawTime / sFrame, matches ? "matches" : "differs");
+
+		std::filesystem::remove(configFile);
+		std::filesystem::remove(sFrameFile);
+	}
+	return passed ? 0 : 1;
+}
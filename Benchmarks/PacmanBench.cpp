@@ -0,0 +1,97 @@
+//====================================================================================================
+// Filename:	PacmanBench.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+// Runs the Pacman game loop headless for a fixed number of frames with a fixed time step and reports
+// throughput. Must be run from the Pacman directory so the stage files and ../Assets are found.
+//
+//   PacmanBench [frames]
+
+#include <EnemyManager.h>
+#include <Game.h>
+#include <XEngine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	constexpr float kTimeStep = 1.0f / 60.0f;
+
+	uint64_t sFrameCount = 600;
+	uint64_t sFrame = 0;
+	double sSimulationTime = 0.0;
+	double sRenderTime = 0.0;
+	uint64_t sAllocations = 0;
+
+	bool BenchLoop(float deltaTime)
+	{
+		// Stats are for the previous frame, which has been rendered by now
+		if (sFrame > 0)
+		{
+			const X::FrameStats& stats = X::GetFrameStats();
+			sSimulationTime += stats.simulationTime;
+			sRenderTime += stats.renderTime;
+			sAllocations += stats.allocations;
+		}
+
+		// Game over is ignored, the ghosts keep running either way
+		GameLoop(kTimeStep);
+		return ++sFrame > sFrameCount;
+	}
+
+	// FNV-1a over every ghost's position and heading, equal between runs with the same seed however
+	// many worker threads decided the ghosts' moves
+	uint32_t HashGhosts()
+	{
+		uint32_t hash = 2166136261u;
+		for (const Ghost* ghost : EnemyManager::Get().GetGhosts())
+		{
+			const float values[] = { ghost->GetPosition().x, ghost->GetPosition().y, ghost->GetHeading().x, ghost->GetHeading().y };
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+			for (size_t i = 0; i < sizeof(values); ++i)
+			{
+				hash = (hash ^ bytes[i]) * 16777619u;
+			}
+		}
+		return hash;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		sFrameCount = std::max(1ull, std::strtoull(argv[1], nullptr, 10));
+	}
+
+	X::Start("pacman.json");
+	GameInit();
+
+	const auto start = std::chrono::steady_clock::now();
+	X::Run(BenchLoop);
+	const auto end = std::chrono::steady_clock::now();
+
+	const float p50 = X::GetFrameTimePercentile(0.50f);
+	const float p99 = X::GetFrameTimePercentile(0.99f);
+	const float maxFrameTime = X::GetMaxFrameTime();
+	const uint32_t hitches = X::GetHitchCount();
+	const uint32_t ghostHash = HashGhosts();
+	const uint32_t workerThreads = X::GetWorkerThreadCount();
+
+	GameCleanUp();
+	X::Stop();
+
+	const double seconds = std::chrono::duration<double>(end - start).count();
+	printf("frames: %llu\n", static_cast<unsigned long long>(sFrameCount));
+	printf("total: %.3f s, %.1f frames/s\n", seconds, sFrameCount / seconds);
+	printf("simulation: %.4f ms/frame\n", sSimulationTime / sFrameCount);
+	printf("render: %.4f ms/frame\n", sRenderTime / sFrameCount);
+	printf("allocations: %.2f/frame\n", static_cast<double>(sAllocations) / sFrameCount);
+	printf("frame time: p50 %.1f ms, p99 %.1f ms, max %.3f ms, %u hitches\n", p50, p99, maxFrameTime, hitches);
+	printf("ghosts: %08x with %u worker threads\n", ghostHash, workerThreads);
+	return 0;
+}
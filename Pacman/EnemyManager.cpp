@@ -4,6 +4,13 @@ namespace
 {
     // instance for the enemy manager
     EnemyManager* sInstance = nullptr;
+
+    // own streams of the session seed so the AI replays the same with the same seed, ghost i uses
+    // kRandomStream + i
+    constexpr uint64_t kRandomStream = 0x47686f7374ull;
+
+    // ghosts decided per job, deciding is a handful of tile lookups
+    constexpr uint32_t kGhostsPerJob = 64;
 }
 
 //----------------------------------------------------------------------------------
@@ -85,178 +92,186 @@ void EnemyManager::CreateGhost(X::Math::Vector2 pos, Ghost::GHOST_COLOUR colour)
     enemy->Load();
     enemy->SetPosition(pos);
     mEnemies.push_back(enemy);
+    mRandoms.emplace_back(X::GetRandomSeed(), kRandomStream + mEnemies.size() - 1);
 }
 
 //----------------------------------------------------------------------------------
 
 void EnemyManager::MovementLogic(float deltaTime)
 {
-    // Movement for the ghosts
-    for (auto enemy : mEnemies)
+    // Decide every ghost's move in parallel against the map as it is now, each ghost draws from its
+    // own random stream so the moves do not depend on which thread decided them
+    const uint32_t ghostCount = static_cast<uint32_t>(mEnemies.size());
+    mMoves.resize(ghostCount);
+    const PacTileMap& map = PacTileMap::Get();
+    X::ParallelFor(ghostCount, kGhostsPerJob, [this, &map](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            DecideMove(*mEnemies[i], map, mRandoms[i], mMoves[i]);
+    });
+
+    // Apply in ghost order
+    for (uint32_t i = 0; i < ghostCount; ++i)
+    {
+        Ghost* enemy = mEnemies[i];
+        enemy->SetHeading(mMoves[i].heading);
+        enemy->SetPosition(mMoves[i].position);
+        enemy->Update(deltaTime);
+    }
+}
+
+//----------------------------------------------------------------------------------
+
+void EnemyManager::DecideMove(const Ghost& enemy, const PacTileMap& map, X::RandomStream& random, GhostMove& move)
+{
+    // Turn the ghost when it is about to hit a wall. Only reads the ghost and the map, the result
+    // is applied later so ghosts can decide on any thread.
+    move.position = enemy.GetPosition();
+    move.heading = enemy.GetHeading();
+    X::Math::Rect bounds = enemy.GetBoundingBox();
+    X::Math::Vector2 heading = enemy.GetHeading();
+    X::Math::Vector2 newHeading = { 0, 0 };
+    if (heading.x > 0.0f)
     {
-        X::Math::Rect bounds = enemy->GetBoundingBox();
-        X::Math::Vector2 heading = enemy->GetHeading();
-        X::Math::Vector2 newHeading = { 0, 0 };
-        if (heading.x > 0.0f)
+        X::Math::LineSegment rightEdge{
+            bounds.max.x + heading.x,
+            bounds.min.y,
+            bounds.max.x + heading.x,
+            bounds.max.y,
+        };
+        if (map.CheckCollision(rightEdge))
         {
-            X::Math::LineSegment rightEdge{
-                bounds.max.x + heading.x,
-                bounds.min.y,
-                bounds.max.x + heading.x,
-                bounds.max.y,
-            };
-            if (PacTileMap::Get().CheckCollision(rightEdge))
+            if (enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ||
+                enemy.GetColour() == Ghost::GHOST_COLOUR::PURPLE)
             {
-                if (enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ||
-                    enemy->GetColour() == Ghost::GHOST_COLOUR::PURPLE)
-                {
-                    newHeading.y = enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ? -1.0f : 1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.x -= 4.0f;
-                    enemy->SetPosition(pos);
-                }
-                else if (enemy->GetColour() == Ghost::GHOST_COLOUR::ORANGE)
-                {
-                    if (randomBool())
-                        newHeading.x = -1.0f;
-                    else
-                        newHeading.y = randomBool()? -1.0f : 1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.x -= 4.0f;
-                    enemy->SetPosition(pos);
-                }
+                newHeading.y = enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ? -1.0f : 1.0f;
+                move.heading = newHeading;
+                move.position.x -= 4.0f;
+            }
+            else if (enemy.GetColour() == Ghost::GHOST_COLOUR::ORANGE)
+            {
+                if (randomBool(random))
+                    newHeading.x = -1.0f;
                 else
-                {
-                    heading.x = -1.0f;
-                    enemy->SetHeading(heading);
-                }
+                    newHeading.y = randomBool(random)? -1.0f : 1.0f;
+                move.heading = newHeading;
+                move.position.x -= 4.0f;
+            }
+            else
+            {
+                heading.x = -1.0f;
+                move.heading = heading;
             }
         }
-        //check right side
-        if (heading.x < 0.0f)
+    }
+    //check right side
+    if (heading.x < 0.0f)
+    {
+        X::Math::LineSegment leftEdge{
+            bounds.min.x + heading.x,
+            bounds.min.y,
+            bounds.min.x + heading.x,
+            bounds.max.y,
+        };
+        if (map.CheckCollision(leftEdge))
         {
-            X::Math::LineSegment leftEdge{
-                bounds.min.x + heading.x,
-                bounds.min.y,
-                bounds.min.x + heading.x,
-                bounds.max.y,
-            };
-            if (PacTileMap::Get().CheckCollision(leftEdge))
+            if (enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ||
+                enemy.GetColour() == Ghost::GHOST_COLOUR::PURPLE)
+            {
+                newHeading.y = enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ? 1.0f : -1.0f;
+                move.heading = newHeading;
+                move.position.x += 4.0f;
+            }
+            else if (enemy.GetColour() == Ghost::GHOST_COLOUR::ORANGE)
             {
-                if (enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ||
-                    enemy->GetColour() == Ghost::GHOST_COLOUR::PURPLE)
-                {
-                    newHeading.y = enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ? 1.0f : -1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.x += 4.0f;
-                    enemy->SetPosition(pos);
-                }
-                else if (enemy->GetColour() == Ghost::GHOST_COLOUR::ORANGE)
-                {
-                    if (randomBool())
-                        newHeading.x = 1.0f;
-                    else
-                        newHeading.y = randomBool() ? -1.0f : 1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.x += 4.0f;
-                    enemy->SetPosition(pos);
-                }
+                if (randomBool(random))
+                    newHeading.x = 1.0f;
                 else
-                {
-                    heading.x = 1.0f;
-                    enemy->SetHeading(heading);
-                }
+                    newHeading.y = randomBool(random) ? -1.0f : 1.0f;
+                move.heading = newHeading;
+                move.position.x += 4.0f;
+            }
+            else
+            {
+                heading.x = 1.0f;
+                move.heading = heading;
             }
         }
-        //check top side
-        if (heading.y > 0.0f)
+    }
+    //check top side
+    if (heading.y > 0.0f)
+    {
+        X::Math::LineSegment bottomEdge{
+            bounds.min.x,
+            bounds.max.y + heading.y,
+            bounds.max.x,
+            bounds.max.y + heading.y,
+        };
+        if (map.CheckCollision(bottomEdge))
         {
-            X::Math::LineSegment bottomEdge{
-                bounds.min.x,
-                bounds.max.y + heading.y,
-                bounds.max.x,
-                bounds.max.y + heading.y,
-            };
-            if (PacTileMap::Get().CheckCollision(bottomEdge))
+            if (enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ||
+                enemy.GetColour() == Ghost::GHOST_COLOUR::PURPLE)
+            {
+                newHeading.x = enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ? 1.0f : -1.0f;
+                move.heading = newHeading;
+                move.position.y -= 4.0f;
+            }
+            else if (enemy.GetColour() == Ghost::GHOST_COLOUR::ORANGE)
             {
-                if (enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ||
-                    enemy->GetColour() == Ghost::GHOST_COLOUR::PURPLE)
-                {
-                    newHeading.x = enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ? 1.0f : -1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.y -= 4.0f;
-                    enemy->SetPosition(pos);
-                }
-                else if (enemy->GetColour() == Ghost::GHOST_COLOUR::ORANGE)
-                {
-                    if (randomBool())
-                        newHeading.x = randomBool() ? -1.0f : 1.0f;
-                    else
-                        newHeading.y = -1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.y -= 4.0f;
-                    enemy->SetPosition(pos);
-                }
+                if (randomBool(random))
+                    newHeading.x = randomBool(random) ? -1.0f : 1.0f;
                 else
-                {
-                    heading.y = -1.0f;
-                    enemy->SetHeading(heading);
-                }
+                    newHeading.y = -1.0f;
+                move.heading = newHeading;
+                move.position.y -= 4.0f;
+            }
+            else
+            {
+                heading.y = -1.0f;
+                move.heading = heading;
             }
         }
-        // check bottom side
-        if (heading.y < 0.0f)
+    }
+    // check bottom side
+    if (heading.y < 0.0f)
+    {
+        X::Math::LineSegment topEdge{
+            bounds.min.x,
+            bounds.min.y + heading.y,
+            bounds.max.x,
+            bounds.min.y + heading.y,
+        };
+        if (map.CheckCollision(topEdge))
         {
-            X::Math::LineSegment topEdge{
-                bounds.min.x,
-                bounds.min.y + heading.y,
-                bounds.max.x,
-                bounds.min.y + heading.y,
-            };
-            if (PacTileMap::Get().CheckCollision(topEdge))
+            if (enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ||
+                enemy.GetColour() == Ghost::GHOST_COLOUR::PURPLE)
             {
-                if (enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ||
-                    enemy->GetColour() == Ghost::GHOST_COLOUR::PURPLE)
-                {
-                    newHeading.x = enemy->GetColour() == Ghost::GHOST_COLOUR::PINK ? -1.0f : 1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.y += 4.0f;
-                    enemy->SetPosition(pos);
-                }
-                else if (enemy->GetColour() == Ghost::GHOST_COLOUR::ORANGE)
-                {
-                    if (randomBool())
-                        newHeading.x = randomBool() ? -1.0f : 1.0f;
-                    else
-                        newHeading.y = 1.0f;
-                    enemy->SetHeading(newHeading);
-                    X::Math::Vector2 pos = enemy->GetPosition();
-                    pos.y += 4.0f;
-                    enemy->SetPosition(pos);
-                }
+                newHeading.x = enemy.GetColour() == Ghost::GHOST_COLOUR::PINK ? -1.0f : 1.0f;
+                move.heading = newHeading;
+                move.position.y += 4.0f;
+            }
+            else if (enemy.GetColour() == Ghost::GHOST_COLOUR::ORANGE)
+            {
+                if (randomBool(random))
+                    newHeading.x = randomBool(random) ? -1.0f : 1.0f;
                 else
-                {
-                    heading.y = 1.0f;
-                    enemy->SetHeading(heading);
-                }
+                    newHeading.y = 1.0f;
+                move.heading = newHeading;
+                move.position.y += 4.0f;
+            }
+            else
+            {
+                heading.y = 1.0f;
+                move.heading = heading;
             }
         }
-        enemy->Update(deltaTime);
     }
 }
 
 //----------------------------------------------------------------------------------
 
-bool EnemyManager::randomBool()
+bool EnemyManager::randomBool(X::RandomStream& random)
 {
     // get a random bool for AI
-    static auto gen = std::bind(std::uniform_int_distribution<>(0, 1), std::default_random_engine());
-    return gen();
+    return random.NextBool();
 }
\ No newline at end of file
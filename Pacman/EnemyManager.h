@@ -21,10 +21,20 @@ public:
     void Render();
 
     // get the ghost enemies
-    std::vector<Ghost*> GetGhosts() const { return mEnemies; }
+    const std::vector<Ghost*>& GetGhosts() const { return mEnemies; }
 private:
-    bool randomBool();
+    // where a ghost goes this frame, decided before any ghost moves
+    struct GhostMove
+    {
+        X::Math::Vector2 position;
+        X::Math::Vector2 heading;
+    };
+
+    static bool randomBool(X::RandomStream& random);
+    static void DecideMove(const Ghost& enemy, const PacTileMap& map, X::RandomStream& random, GhostMove& move);
     void CreateGhost(X::Math::Vector2 pos, Ghost::GHOST_COLOUR colour);
     void MovementLogic(float deltaTime);
     std::vector<Ghost*> mEnemies;
+    std::vector<X::RandomStream> mRandoms;
+    std::vector<GhostMove> mMoves;
 };
\ No newline at end of file
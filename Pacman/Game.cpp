@@ -0,0 +1,124 @@
+//Game state and main loop for the game.
+
+#include "Game.h"
+#include "EnemyManager.h"
+#include "PacTileMap.h"
+#include "Player.h"
+#include <XEngine.h>
+
+Character* player = new Player();
+char scoreText[16] = "0";
+int scoreShown = 0;
+bool debug = false;
+X::SoundId pacSong;
+bool start = false;
+std::vector<X::Math::Rect> ghostBounds;
+std::vector<uint32_t> ghostHits;
+
+//----------------------------------------------------------------------------------
+
+void GameInit()
+{
+    PacTileMap::StaticInitialize();
+    PacTileMap::Get().Load();
+
+    EnemyManager::StaticInitialize();
+    EnemyManager::Get().Load();
+
+    player->SetPosition({ 48.0f, 244.0f });
+    player->Load();
+
+    X::SetBackgroundColor(X::Colors::Black);
+    pacSong = X::LoadSoundAsync("PacMan_intro_music.wav");
+}
+
+//----------------------------------------------------------------------------------
+
+void GameCleanUp()
+{
+    PacTileMap::Get().Unload();
+    PacTileMap::StaticTerminate();
+
+    EnemyManager::Get().Unload();
+    EnemyManager::StaticTerminate();
+
+    player->Unload();
+    delete player;
+    player = nullptr;
+}
+
+//----------------------------------------------------------------------------------
+
+bool GameLoop(float deltaTime)
+{
+    // sprites are grouped by texture within a layer, layers keep the map under the actors
+    X::SetSpriteLayer(0);
+    PacTileMap::Get().Render();
+    X::SetSpriteLayer(1);
+    player->Render();
+    X::SetSpriteLayer(2);
+    PacTileMap::Get().RenderOutside();
+    X::SetSpriteLayer(3);
+    EnemyManager::Get().Render();
+
+    if (!start)
+    {
+        // the intro music is still loading, if it failed the game starts without it
+        if (X::IsSoundLoading(pacSong))
+            return false;
+        X::PlaySoundOneShot(pacSong);
+        start = !start;
+    }
+    if (X::IsSoundPlaying(pacSong))
+        return false;
+    PacTileMap::Get().Update(deltaTime);
+    player->Update(deltaTime);
+    EnemyManager::Get().Update(deltaTime);
+
+
+    X::Math::Rect bounds = player->GetBoundingBox();
+    if (debug)
+        X::DrawScreenRect(bounds, X::Colors::Red);
+    // only format the score when it changes
+    int points = player->GetScore();
+    if (points != scoreShown)
+    {
+        snprintf(scoreText, sizeof(scoreText), "%d", points);
+        scoreShown = points;
+    }
+    X::DrawScreenText(scoreText, 700, 20, 0, X::Colors::Red);
+    if (X::IsKeyPressed(X::Keys::GRAVE))
+    {
+        debug = !debug;
+        X::ShowPerformanceHud(debug);
+    }
+    const std::vector<Ghost*>& ghosts = EnemyManager::Get().GetGhosts();
+    X::SetPerformanceCounter("Ghosts", static_cast<int>(ghosts.size()));
+    const uint32_t ghostCount = static_cast<uint32_t>(ghosts.size());
+    ghostBounds.resize(ghostCount);
+    ghostHits.resize((ghostCount + 31) / 32);
+    for (uint32_t i = 0; i < ghostCount; ++i)
+    {
+        ghostBounds[i] = ghosts[i]->GetBoundingBox();
+        if (debug)
+            X::DrawScreenRect(ghostBounds[i], X::Colors::White);
+    }
+    PacTileMap::Get().HitEnemies(bounds, ghostBounds.data(), ghostCount, ghostHits.data());
+    for (uint32_t i = 0; i < ghostCount; ++i)
+    {
+        Ghost* enemy = ghosts[i];
+        if (ghostHits[i / 32] & (1u << (i % 32)))
+        {
+            if (!PacTileMap::Get().GetPowerMode())
+                return true;
+            else
+            {
+                enemy->SetAlive();
+                enemy->SetRevive(10.0f);
+                X::MarkFrameEvent("GhostEaten");
+            }
+        }
+    }
+    return X::IsKeyPressed(X::Keys::ESCAPE);
+    
+}
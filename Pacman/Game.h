@@ -0,0 +1,9 @@
+#pragma once
+
+//Game setup and per frame update, shared by WinMain and the benchmarks.
+
+void GameInit();
+void GameCleanUp();
+
+//Returns true once the game is over or the player quits
+bool GameLoop(float deltaTime);
@@ -9,49 +9,52 @@ namespace {
 
 void Ghost::Load()
 {
+    mMoveSpeed = X::ConfigFindFloat("GhostSpeed", 100.0f);
+    mPowerMoveSpeed = X::ConfigFindFloat("GhostPowerSpeed", 50.0f);
+
     // load ghost sprites
-    mPowerSprite.push_back(X::LoadTexture("ghost_ded1.png"));
-    mPowerSprite.push_back(X::LoadTexture("ghost_ded1.png"));
-    mPowerSprite.push_back(X::LoadTexture("ghost_ded2.png"));
-    mPowerSprite.push_back(X::LoadTexture("ghost_ded2.png"));
+    mPowerSprite.push_back(X::LoadTextureAsync("ghost_ded1.png"));
+    mPowerSprite.push_back(X::LoadTextureAsync("ghost_ded1.png"));
+    mPowerSprite.push_back(X::LoadTextureAsync("ghost_ded2.png"));
+    mPowerSprite.push_back(X::LoadTextureAsync("ghost_ded2.png"));
     if (mColour == GHOST_COLOUR::RED)
     {
-        mEnemySprite.push_back(X::LoadTexture("red_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("red_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("red_ghost2.png"));
-        mEnemySprite.push_back(X::LoadTexture("red_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("red_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("red_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("red_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("red_ghost2.png"));
         mHeading = { 1, 0 };
     }
     else if (mColour == GHOST_COLOUR::BLUE)
     {
-        mEnemySprite.push_back(X::LoadTexture("blue_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("blue_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("blue_ghost2.png"));
-        mEnemySprite.push_back(X::LoadTexture("blue_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("blue_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("blue_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("blue_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("blue_ghost2.png"));
         mHeading = { 0, 1 };
     }
     else if (mColour == GHOST_COLOUR::PINK)
     {
-        mEnemySprite.push_back(X::LoadTexture("pink_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("pink_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("pink_ghost2.png"));
-        mEnemySprite.push_back(X::LoadTexture("pink_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("pink_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("pink_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("pink_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("pink_ghost2.png"));
         mHeading = { 0, 1 };
     }
     else if (mColour == GHOST_COLOUR::PURPLE)
     {
-        mEnemySprite.push_back(X::LoadTexture("purple_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("purple_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("purple_ghost2.png"));
-        mEnemySprite.push_back(X::LoadTexture("purple_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("purple_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("purple_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("purple_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("purple_ghost2.png"));
         mHeading = { -1, 0 };
     }
     else if (mColour == GHOST_COLOUR::ORANGE)
     {
-        mEnemySprite.push_back(X::LoadTexture("orange_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("orange_ghost1.png"));
-        mEnemySprite.push_back(X::LoadTexture("orange_ghost2.png"));
-        mEnemySprite.push_back(X::LoadTexture("orange_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("orange_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("orange_ghost1.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("orange_ghost2.png"));
+        mEnemySprite.push_back(X::LoadTextureAsync("orange_ghost2.png"));
         mHeading = { 0, -1 };
     }
     else
@@ -102,7 +105,7 @@ void Ghost::Update(float deltaTime)
         mPosition = { 0,0 };
         return;
     }
-    const float moveSpeed = PacTileMap::Get().GetPowerMode()? 50.0f : 100.0f;
+    const float moveSpeed = PacTileMap::Get().GetPowerMode()? mPowerMoveSpeed.Get() : mMoveSpeed.Get();
     mPosition += mHeading * moveSpeed * deltaTime;
 }
 
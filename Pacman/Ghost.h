@@ -45,4 +45,8 @@ private:
     // alive
     bool mIsAlive = true;
     float mRevive = 1000.0f;
+
+    // tuning, live from the config file
+    X::ConfigFloat mMoveSpeed;
+    X::ConfigFloat mPowerMoveSpeed;
 };
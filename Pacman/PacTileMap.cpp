@@ -34,6 +34,8 @@ PacTileMap& PacTileMap::Get()
 //----------------------------------------------------------------------------------
 void PacTileMap::Load()
 {
+    mPowerTime = X::ConfigFindFloat("PowerTime", 15.0f);
+
     //get the stage text file
     std::string line;
     std::ifstream myFile("stage3.txt");
@@ -48,6 +50,9 @@ void PacTileMap::Load()
     {
         while (std::getline(myFile, line))
         {
+            // the stage files have Windows line endings
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
             if (rows == 0)
                 rows = line.length();
             else if (rows != line.length())
@@ -77,15 +82,15 @@ void PacTileMap::Load()
         }
     }
     //Open,
-    mTilesTexture.push_back(X::LoadTexture("black3.png"));
+    mTilesTexture.push_back(X::LoadTextureAsync("black3.png"));
     //Wall,
-    mTilesTexture.push_back(X::LoadTexture("blue3.png"));
+    mTilesTexture.push_back(X::LoadTextureAsync("blue3.png"));
     //Ball
-    mTilesTexture.push_back(X::LoadTexture("orb2.png"));
+    mTilesTexture.push_back(X::LoadTextureAsync("orb2.png"));
     //Power Orb
-    mTilesTexture.push_back(X::LoadTexture("power_orb.png"));
+    mTilesTexture.push_back(X::LoadTextureAsync("power_orb.png"));
     //White Border
-    mTilesTexture.push_back(X::LoadTexture("white2.png"));
+    mTilesTexture.push_back(X::LoadTextureAsync("white2.png"));
 }
 
 //----------------------------------------------------------------------------------
@@ -207,4 +212,11 @@ bool PacTileMap::HitEnemy(const X::Math::Rect player, const X::Math::Rect enemy)
 {
     // see if a player and an enemy collide
     return X::Math::Intersect(player, enemy);
+}
+
+//----------------------------------------------------------------------------------
+uint32_t PacTileMap::HitEnemies(const X::Math::Rect& player, const X::Math::Rect* enemies, uint32_t count, uint32_t* hitMask) const
+{
+    // test the player against every enemy at once
+    return X::Math::Intersect(player, enemies, count, hitMask);
 }
\ No newline at end of file
@@ -34,11 +34,13 @@ public:
     bool CheckCollision(const X::Math::LineSegment& lineSegment) const;
     X::Math::Vector2 GetMaxBoundaries() const;
     bool HitEnemy(const X::Math::Rect player, const X::Math::Rect enemy) const;
+    // Sets bit i of hitMask for every enemy the player touches, returns how many
+    uint32_t HitEnemies(const X::Math::Rect& player, const X::Math::Rect* enemies, uint32_t count, uint32_t* hitMask) const;
     bool GetTeleportFlag() const { return mTeleport; }
 
     // Score
     bool GetPowerMode() const{ return mPowerMode; }
-    void SetPowerTimer() { mPowerTimer = 15.0f; }
+    void SetPowerTimer() { mPowerTimer = mPowerTime.Get(); }
 private:
     // Get tile
     int GetIndex(int row, int column) const;
@@ -54,5 +56,6 @@ private:
     mutable bool mTeleport = false;
     float mPowerTimer = 0.0f;
     bool mPowerMode = false;
+    X::ConfigFloat mPowerTime;
 
 };
@@ -9,15 +9,17 @@ namespace {
 
 void Player::Load()
 {
+    mMoveSpeed = X::ConfigFindFloat("PlayerSpeed", 200.0f);
+
     // load the pacman sprite
-    mCharacterSprite.push_back(X::LoadTexture("Pacman1_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman1_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman2_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman2_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman3_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman3_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman2_2.png"));
-    mCharacterSprite.push_back(X::LoadTexture("Pacman2_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman1_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman1_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman2_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman2_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman3_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman3_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman2_2.png"));
+    mCharacterSprite.push_back(X::LoadTextureAsync("Pacman2_2.png"));
 
 }
 
@@ -50,7 +52,7 @@ void Player::Update(float deltaTime)
     //speed and teleport check variables
     bool rightTeleport = false;
     bool leftTeleport = false;
-    const float moveSpeed = 200.0f;
+    const float moveSpeed = mMoveSpeed.Get();
     //character movement
     X::Math::Vector2 offset = { 0, 0 };
     if (X::IsKeyDown(X::Keys::D) || X::IsKeyDown(X::Keys::RIGHT))
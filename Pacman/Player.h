@@ -33,4 +33,7 @@ private:
     // points
     int mPoints = 0;
 
+    // tuning, live from the config file
+    X::ConfigFloat mMoveSpeed;
+
 };
@@ -159,6 +159,17 @@ constexpr Color Yellow					{ 1.000000000f, 1.000000000f, 0.000000000f, 1.0000000
 constexpr Color YellowGreen				{ 0.603921592f, 0.803921640f, 0.196078449f, 1.000000000f };
 
 } // namespace Colors
+
+// RGBA8 with red in the lowest byte (0xAABBGGRR), the layout of DXGI_FORMAT_R8G8B8A8_UNORM
+inline uint32_t PackColor(const Color& color)
+{
+	const uint32_t r = static_cast<uint32_t>(Math::Clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const uint32_t g = static_cast<uint32_t>(Math::Clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const uint32_t b = static_cast<uint32_t>(Math::Clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const uint32_t a = static_cast<uint32_t>(Math::Clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
 } // namespace X
 
 #endif // #ifndef INCLUDED_XENGINE_COLORS_H
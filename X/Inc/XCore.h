@@ -6,15 +6,13 @@
 #ifndef INCLUDED_XENGINE_CORE_H
 #define INCLUDED_XENGINE_CORE_H
 
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-
-#include <Windows.h>
-
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
@@ -32,24 +30,26 @@
 #include <variant>
 #include <vector>
 
+#include "XPlatform.h"
+
 //----------------------------------------------------------------------------------------------------
 
 #if defined(_DEBUG)
 	#define XLOG(format, ...)\
 		do {\
 			char _buffer[4096];\
-			int ret = _snprintf_s(_buffer, std::size(_buffer), _TRUNCATE, "%s(%d) "##format, __FILE__, __LINE__, __VA_ARGS__);\
-			OutputDebugStringA(_buffer);\
-			if (ret == -1) OutputDebugStringA("** message truncated **\n");\
-			OutputDebugStringA("\n");\
+			int ret = snprintf(_buffer, std::size(_buffer), "%s(%d) " format, __FILE__, __LINE__, ##__VA_ARGS__);\
+			X::Platform::DebugOutput(_buffer);\
+			if (ret >= static_cast<int>(std::size(_buffer))) X::Platform::DebugOutput("** message truncated **\n");\
+			X::Platform::DebugOutput("\n");\
 		} while (false)
 
 	#define XASSERT(condition, format, ...)\
 		do {\
 			if (!(condition))\
 			{\
-				XLOG(format, __VA_ARGS__);\
-				DebugBreak();\
+				XLOG(format, ##__VA_ARGS__);\
+				X::Platform::BreakIntoDebugger();\
 			}\
 		} while (false)
 
@@ -57,8 +57,8 @@
 		do {\
 			if (!(condition))\
 			{\
-				XLOG(format, __VA_ARGS__);\
-				DebugBreak();\
+				XLOG(format, ##__VA_ARGS__);\
+				X::Platform::BreakIntoDebugger();\
 			}\
 		} while (false)
 #else
@@ -71,10 +71,6 @@
 
 namespace X {
 
-using WindowMessageHandler = LRESULT(CALLBACK*)(HWND, UINT, WPARAM, LPARAM);
-
-//----------------------------------------------------------------------------------------------------
-
 template <typename T>
 inline void SafeDelete(T*& ptr)
 {
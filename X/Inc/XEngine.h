@@ -9,6 +9,7 @@
 #include "XCore.h"
 #include "XColors.h"
 #include "XMath.h"
+#include "XRandom.h"
 #include "XTypes.h"
 
 namespace X {
@@ -23,8 +24,32 @@ bool ConfigGetBool(const char* key, bool defaultValue = false);
 float ConfigGetFloat(const char* key, float defaultValue = 0.0f);
 const char* ConfigGetString(const char* key, const char* defaultValue = "");
 
+// Config Handle Functions
+// Note: the ConfigGet functions search the file by name on every call. For values read every frame,
+// resolve the key once and keep the handle. With Config "HotReload" set the file is watched, changes
+// are swapped in all at once at the start of a frame and show up through the handles. Strings from
+// ConfigGetString are only good until the next frame once the file has been reloaded.
+ConfigInt ConfigFindInt(const char* key, int defaultValue = 0);
+ConfigBool ConfigFindBool(const char* key, bool defaultValue = false);
+ConfigFloat ConfigFindFloat(const char* key, float defaultValue = 0.0f);
+
 // Time Functions
+// Note: GetTime and the delta time passed to the game loop are scaled by the time scale (Config
+// "TimeScale", e.g. 0.25 for slow motion or 20 to fast forward). Config "FixedTimeStep" advances time
+// by that many seconds every frame instead of reading the real clock.
+// Frame times and the frame rate are real time whatever the time scale or step, in milliseconds and
+// cover every frame since X::Run started or the last reset, percent is between 0 and 1. A hitch is a
+// frame taking over twice the moving average and at least 4 ms longer than it. Set Config "TargetFPS"
+// (or call SetTargetFrameRate) to cap the frame rate, 0 is uncapped.
 float GetTime();
+void SetTimeScale(float scale);
+float GetTimeScale();
+float GetFramesPerSecond();
+float GetFrameTimePercentile(float percent);
+float GetMaxFrameTime();
+uint32_t GetHitchCount();
+void ResetFrameTimeStats();
+void SetTargetFrameRate(float framesPerSecond);
 
 // Camera Functions
 void SetCameraPosition(const Math::Vector3& position);
@@ -37,15 +62,28 @@ void ClearAllSounds();
 TextureId LoadTexture(const char* fileName);
 void ClearAllTextures();
 
+// Async Resource Functions
+// Note: files are decoded on loader threads (Config "LoaderThreads") and the handle becomes usable once
+// Is*Ready returns true. Drawing or playing before that does nothing. Textures requested before
+// X::Run are always ready by the first frame. Is*Loading is true until the load has finished, a file
+// that fails to load stops loading without ever becoming ready, so wait on Is*Loading.
+SoundId LoadSoundAsync(const char* fileName);
+bool IsSoundReady(SoundId soundId);
+bool IsSoundLoading(SoundId soundId);
+TextureId LoadTextureAsync(const char* fileName);
+bool IsTextureReady(TextureId textureId);
+bool IsTextureLoading(TextureId textureId);
+
 // File Dialog Functions
 // Note: filter string has format "<Description>\0*.<extension>\0", with multiple entries separated by ;
 // e.g
 //   "Text Files (*.txt)\0*.txt"
 //   "PNG Files (*.png)\0*.png;\0JPG Files (*.jpg)\0*.jpg"
-bool OpenFileDialog(char fileName[MAX_PATH], const char* title, const char* filter);
-bool SaveFileDialog(char fileName[MAX_PATH], const char* title, const char* filter);
+bool OpenFileDialog(char fileName[Platform::kMaxPath], const char* title, const char* filter);
+bool SaveFileDialog(char fileName[Platform::kMaxPath], const char* title, const char* filter);
 
 // Audio Functions
+// Note: sound is only played on Windows, elsewhere sounds are always ready and never playing
 void PlaySoundOneShot(SoundId soundId);
 void PlaySoundLoop(SoundId soundId);
 bool IsSoundPlaying(SoundId id);
@@ -74,18 +112,78 @@ void DrawScreenDiamond(const Math::Vector2& center, float size, const Color& col
 void DrawScreenDiamond(float x, float y, float size, const Color& color);
 void DrawScreenText(const char* str, float x, float y, float size, const Color& color);
 
+// Performance Hud Functions
+void ShowPerformanceHud(bool show);
+bool IsPerformanceHudVisible();
+void SetPerformanceCounter(const char* name, int value);
+
+// Frame Stats Functions
+// Note: stats are for the last completed frame. Set Config "StatsFile" to stream every frame to a .csv
+// or .json file, MarkFrameEvent tags the current frame so spikes can be matched with gameplay. Mark
+// events from the game thread only.
+const FrameStats& GetFrameStats();
+void MarkFrameEvent(const char* name);
+
 // Sprite Functions
+// Note: sprites are grouped by texture before drawing, so draw order is only guaranteed between layers.
+// The layer applies to every following DrawSprite call and resets to 0 each frame.
+// Any thread may draw sprites, before the game loop returns to be part of that frame. Sprites drawn
+// from other threads or from inside a job, on any thread, draw after the game thread's other sprites
+// within the same layer and texture, ordered by position, so the frame does not depend on how jobs
+// were scheduled. Other threads keep their own layer for the frame. Inside a job the layer starts at
+// 0 and only lasts for that job, set it again after waiting on other jobs.
+void SetSpriteLayer(uint8_t layer);
 void DrawSprite(TextureId textureId, const Math::Vector2& position, Pivot pivot = Pivot::Center, Flip flip = Flip::None);
 void DrawSprite(TextureId textureId, const Math::Vector2& position, float rotation, Pivot pivot = Pivot::Center, Flip flip = Flip::None);
 void DrawSprite(TextureId textureId, const Math::Rect& sourceRect, const Math::Vector2& position);
 uint32_t GetSpriteWidth(TextureId textureId);
 uint32_t GetSpriteHeight(TextureId textureId);
+// Note: textures packed into the atlas share their page, so this returns the whole page
 void* GetSprite(TextureId textureId);
 
 uint32_t GetScreenWidth();
 uint32_t GetScreenHeight();
 
+// Software Rendering Functions
+// Note: set Config "Renderer" to "Software" to draw on the CPU instead of D3D11. Sprites use nearest
+// sampling, 3D debug lines and the performance HUD are not drawn. SaveFrame writes the frame being
+// built to a PNG once it has been rendered. Outside Windows there is no D3D11 and no window, the
+// engine always renders in software and the frame is only kept for SaveFrame.
+// Config "ThreadedRendering" draws each frame on a render thread while the game simulates the next
+// one. Frames are shown one frame later and the reported render time is that of the previous frame.
+// Only the software renderer threads; with D3D11 the setting is ignored.
+bool IsSoftwareRendering();
+void SaveFrame(const char* fileName);
+
+// Job Functions
+// Note: jobs run on Config "WorkerThreads" worker threads, by default one less than the hardware
+// threads. Waiting runs jobs on the waiting thread until the counter is done, so with 0 workers jobs
+// run when they are waited on. Jobs must not wait on anything but job counters.
+void RunJob(JobFunction function, void* data, JobCounter& counter);
+void RunJobAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter& counter);
+void WaitForJobs(JobCounter& counter);
+uint32_t GetWorkerThreadCount();
+
+// Calls function(begin, end) on slices of [0, count) no smaller than grainSize and returns once every
+// slice is done. Slices may run in any order on any thread.
+void ParallelFor(uint32_t count, uint32_t grainSize, JobRangeFunction function, void* data);
+
+template <class Function>
+void ParallelFor(uint32_t count, uint32_t grainSize, Function&& function)
+{
+	using Callable = std::remove_reference_t<Function>;
+	ParallelFor(count, grainSize, [](void* data, uint32_t begin, uint32_t end)
+	{
+		(*static_cast<Callable*>(data))(begin, end);
+	}, const_cast<void*>(static_cast<const void*>(&function)));
+}
+
 // Random Functions
+// Note: every thread draws from its own stream of the session seed, set with Config "RandomSeed" or
+// SetRandomSeed (0 picks a new seed each run). Threads get their stream in the order they first ask,
+// so anything that has to replay the same way should own a RandomStream.
+void SetRandomSeed(uint64_t seed);
+uint64_t GetRandomSeed();
 int Random();
 int Random(int min, int max);
 float RandomFloat();
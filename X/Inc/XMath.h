@@ -6,12 +6,102 @@
 #ifndef INCLUDED_XENGINE_MATH_H
 #define INCLUDED_XENGINE_MATH_H
 
+#include <cfloat>
 #include <math.h>
 #include <vector>
 
+// Matrix multiply and transforms use SSE or NEON when available. The types keep their plain float
+// layout, rows are loaded unaligned.
+#if defined(_M_X64) || defined(__SSE2__)
+	#include <xmmintrin.h>
+	#define XMATH_SSE
+#elif defined(_M_ARM64) || defined(__aarch64__)
+	#include <arm_neon.h>
+	#define XMATH_NEON
+#endif
+
 namespace X {
 namespace Math {
 
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+namespace Simd {
+
+#if defined(XMATH_SSE)
+using Float4 = __m128;
+inline Float4 Load(const float* p)						{ return _mm_loadu_ps(p); }
+inline void Store(float* p, Float4 v)					{ _mm_storeu_ps(p, v); }
+inline Float4 Splat(float f)							{ return _mm_set1_ps(f); }
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline Float4 Mul(Float4 a, Float4 b)					{ return _mm_mul_ps(a, b); }
+// { x0, y0, x1, y1 } to { x0, x0, x1, x1 } and { y0, y0, y1, y1 }
+inline void SplitPairs(Float4 v, Float4& x, Float4& y)	{ x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0)); y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1)); }
+inline Float4 Add(Float4 a, Float4 b)					{ return _mm_add_ps(a, b); }
+inline Float4 Sub(Float4 a, Float4 b)					{ return _mm_sub_ps(a, b); }
+inline Float4 Div(Float4 a, Float4 b)					{ return _mm_div_ps(a, b); }
+inline Float4 Min(Float4 a, Float4 b)					{ return _mm_min_ps(a, b); }
+inline Float4 Max(Float4 a, Float4 b)					{ return _mm_max_ps(a, b); }
+// { x, y, z, w } to { y, z, w, x }
+inline Float4 Rotate(Float4 v)							{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 3, 2, 1)); }
+inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d)	{ _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+// Lane masks from comparisons, all bits set where true
+using Mask4 = __m128;
+inline Mask4 Less(Float4 a, Float4 b)					{ return _mm_cmplt_ps(a, b); }
+inline Mask4 LessEqual(Float4 a, Float4 b)				{ return _mm_cmple_ps(a, b); }
+inline Mask4 Equal(Float4 a, Float4 b)					{ return _mm_cmpeq_ps(a, b); }
+inline Mask4 And(Mask4 a, Mask4 b)						{ return _mm_and_ps(a, b); }
+inline Mask4 AndNot(Mask4 a, Mask4 b)					{ return _mm_andnot_ps(b, a); }
+inline Mask4 Or(Mask4 a, Mask4 b)						{ return _mm_or_ps(a, b); }
+// One bit per lane, lane 0 in bit 0
+inline uint32_t MoveMask(Mask4 m)						{ return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+#else
+using Float4 = float32x4_t;
+inline Float4 Load(const float* p)						{ return vld1q_f32(p); }
+inline void Store(float* p, Float4 v)					{ vst1q_f32(p, v); }
+inline Float4 Splat(float f)							{ return vdupq_n_f32(f); }
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return vmlaq_f32(c, a, b); }
+inline Float4 Mul(Float4 a, Float4 b)					{ return vmulq_f32(a, b); }
+inline void SplitPairs(Float4 v, Float4& x, Float4& y)	{ const float32x4x2_t t = vtrnq_f32(v, v); x = t.val[0]; y = t.val[1]; }
+inline Float4 Add(Float4 a, Float4 b)					{ return vaddq_f32(a, b); }
+inline Float4 Sub(Float4 a, Float4 b)					{ return vsubq_f32(a, b); }
+inline Float4 Div(Float4 a, Float4 b)					{ return vdivq_f32(a, b); }
+inline Float4 Min(Float4 a, Float4 b)					{ return vminq_f32(a, b); }
+inline Float4 Max(Float4 a, Float4 b)					{ return vmaxq_f32(a, b); }
+inline Float4 Rotate(Float4 v)							{ return vextq_f32(v, v, 1); }
+inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d)
+{
+	const float32x4x2_t ab = vtrnq_f32(a, b);
+	const float32x4x2_t cd = vtrnq_f32(c, d);
+	a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+	b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+	c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+	d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+using Mask4 = uint32x4_t;
+inline Mask4 Less(Float4 a, Float4 b)					{ return vcltq_f32(a, b); }
+inline Mask4 LessEqual(Float4 a, Float4 b)				{ return vcleq_f32(a, b); }
+inline Mask4 Equal(Float4 a, Float4 b)					{ return vceqq_f32(a, b); }
+inline Mask4 And(Mask4 a, Mask4 b)						{ return vandq_u32(a, b); }
+inline Mask4 AndNot(Mask4 a, Mask4 b)					{ return vbicq_u32(a, b); }
+inline Mask4 Or(Mask4 a, Mask4 b)						{ return vorrq_u32(a, b); }
+inline uint32_t MoveMask(Mask4 m)
+{
+	const int32_t shifts[4] = { 0, 1, 2, 3 };
+	return vaddvq_u32(vshlq_u32(vshrq_n_u32(m, 31), vld1q_s32(shifts)));
+}
+#endif
+
+// Row vector times a row major 4x4 matrix: v.x * row1 + v.y * row2 + v.z * row3 + v.w * row4
+inline Float4 Transform(float x, float y, float z, float w, const float* m)
+{
+	const Float4 r = MulAdd(Splat(x), Load(m), Mul(Splat(y), Load(m + 4)));
+	return MulAdd(Splat(z), Load(m + 8), MulAdd(Splat(w), Load(m + 12), r));
+}
+
+} // namespace Simd
+#endif
+
 struct Vector2
 {
 	float x, y;
@@ -262,6 +352,18 @@ struct Matrix4
 	}
 	Matrix4 operator*(const Matrix4& rhs) const
 	{
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+		// Each result row is that row of this matrix transforming rhs
+		const float* a = &_11;
+		const float* b = &rhs._11;
+		Matrix4 result;
+		float* r = &result._11;
+		Simd::Store(r, Simd::Transform(a[0], a[1], a[2], a[3], b));
+		Simd::Store(r + 4, Simd::Transform(a[4], a[5], a[6], a[7], b));
+		Simd::Store(r + 8, Simd::Transform(a[8], a[9], a[10], a[11], b));
+		Simd::Store(r + 12, Simd::Transform(a[12], a[13], a[14], a[15], b));
+		return result;
+#else
 		return Matrix4(
 			(_11 * rhs._11) + (_12 * rhs._21) + (_13 * rhs._31) + (_14 * rhs._41),
 			(_11 * rhs._12) + (_12 * rhs._22) + (_13 * rhs._32) + (_14 * rhs._42),
@@ -282,6 +384,7 @@ struct Matrix4
 			(_41 * rhs._12) + (_42 * rhs._22) + (_43 * rhs._32) + (_44 * rhs._42),
 			(_41 * rhs._13) + (_42 * rhs._23) + (_43 * rhs._33) + (_44 * rhs._43),
 			(_41 * rhs._14) + (_42 * rhs._24) + (_43 * rhs._34) + (_44 * rhs._44));
+#endif
 	}
 	Matrix4 operator*(float s) const
 	{
@@ -583,8 +686,18 @@ inline Matrix3 Inverse(const Matrix3& m)
 	return Adjoint(m) * invDet;
 }
 
+// Inverse of a matrix whose last column is (0, 0, 0, 1), i.e. any mix of scale, rotation and translation
+Matrix4 InverseAffine(const Matrix4& m);
+
+inline bool IsAffine(const Matrix4& m)								{ return m._14 == 0.0f && m._24 == 0.0f && m._34 == 0.0f && m._44 == 1.0f; }
+
 inline Matrix4 Inverse(const Matrix4& m)
 {
+	if (IsAffine(m))
+	{
+		return InverseAffine(m);
+	}
+
 	const float determinant = Determinant(m);
 	const float invDet = 1.0f / determinant;
 	return Adjoint(m) * invDet;
@@ -622,12 +735,18 @@ inline Vector2 TransformCoord(const Vector2& v, const Matrix3& m)
 
 inline Vector3 TransformCoord(const Vector3& v, const Matrix4& m)
 {
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	float r[4];
+	Simd::Store(r, Simd::Transform(v.x, v.y, v.z, 1.0f, &m._11));
+	return Vector3(r[0], r[1], r[2]);
+#else
 	return Vector3
 	(
 		v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41,
 		v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42,
 		v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43
 	);
+#endif
 }
 
 inline Vector2 TransformNormal(const Vector2& v, const Matrix3& m)
@@ -641,14 +760,28 @@ inline Vector2 TransformNormal(const Vector2& v, const Matrix3& m)
 
 inline Vector3 TransformNormal(const Vector3& v, const Matrix4& m)
 {
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	float r[4];
+	Simd::Store(r, Simd::Transform(v.x, v.y, v.z, 0.0f, &m._11));
+	return Vector3(r[0], r[1], r[2]);
+#else
 	return Vector3
 	(
 		v.x * m._11 + v.y * m._21 + v.z * m._31,
 		v.x * m._12 + v.y * m._22 + v.z * m._32,
 		v.x * m._13 + v.y * m._23 + v.z * m._33
 	);
+#endif
 }
 
+// Batch transforms, in and out may be the same array. The Matrix4 versions treat z as 0. There are no
+// Vector3 batches, the single point versions already fill three of the four lanes and a four point
+// batch measured no faster.
+void TransformCoord(const Vector2* in, Vector2* out, uint32_t count, const Matrix3& m);
+void TransformCoord(const Vector2* in, Vector2* out, uint32_t count, const Matrix4& m);
+void TransformNormal(const Vector2* in, Vector2* out, uint32_t count, const Matrix3& m);
+void TransformNormal(const Vector2* in, Vector2* out, uint32_t count, const Matrix4& m);
+
 Quaternion QuaternionLookRotation(const Vector3& forward, const Vector3& up);
 Quaternion QuaternionRotationAxis(const Vector3& axis, float rad);
 Matrix4 MatrixRotationAxis(const Vector3& axis, float rad);
@@ -672,6 +805,14 @@ bool Intersect(const Circle& c, const LineSegment& l, Vector2* closestPoint = nu
 bool Intersect(const Circle& c, const Rect& r);
 bool Intersect(const Rect& r, const Circle& c);
 
+// One probe against an array of candidates, four at a time. Bit i of hitMask is set when candidate i
+// hits, hitMask needs (count + 31) / 32 words. Returns the number of hits.
+uint32_t Intersect(const LineSegment& probe, const LineSegment* segments, uint32_t count, uint32_t* hitMask);
+uint32_t Intersect(const Circle& probe, const Circle* circles, uint32_t count, uint32_t* hitMask);
+uint32_t Intersect(const Rect& probe, const Rect* rects, uint32_t count, uint32_t* hitMask);
+uint32_t Intersect(const Circle& probe, const LineSegment* segments, uint32_t count, uint32_t* hitMask);
+uint32_t Intersect(const Circle& probe, const Rect* rects, uint32_t count, uint32_t* hitMask);
+
 bool Intersect(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& distance);
 bool Intersect(const Ray& ray, const Plane& plane, float& distance);
 bool Intersect(const Ray& ray, const AABB& aabb, float& distEntry, float& distExit);
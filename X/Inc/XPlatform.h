@@ -0,0 +1,46 @@
+//====================================================================================================
+// Filename:	XPlatform.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_PLATFORM_H
+#define INCLUDED_XENGINE_PLATFORM_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+// Operating system services used by the core. Implemented by PlatformWin32.cpp and PlatformPosix.cpp,
+// nothing outside those files should include OS headers.
+namespace X {
+namespace Platform {
+
+constexpr uint32_t kMaxPath = 260;
+
+// Debugger
+void DebugOutput(const char* message);
+void BreakIntoDebugger();
+
+// Monotonic high resolution clock
+uint64_t GetClockTicks();
+uint64_t GetClockFrequency();
+
+// Files, mode is the same as fopen. GetFileStamp returns the size and last write time in an OS
+// specific unit, only good for comparing against a previous stamp.
+FILE* OpenFile(const char* fileName, const char* mode);
+bool GetFileStamp(const char* fileName, uint64_t& fileSize, uint64_t& fileTime);
+
+// Strings
+int CompareNoCase(const char* a, const char* b);
+
+// Blocks while value still equals expected and may return early, callers re-check in a loop.
+// WakeValue releases one thread blocked on value, WakeAllValue every one. Fences are built on these
+// instead of a mutex.
+void WaitOnValue(const std::atomic<uint32_t>& value, uint32_t expected);
+void WakeValue(const std::atomic<uint32_t>& value);
+void WakeAllValue(const std::atomic<uint32_t>& value);
+
+} // namespace Platform
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_PLATFORM_H
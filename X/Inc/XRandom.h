@@ -0,0 +1,116 @@
+//====================================================================================================
+// Filename:	XRandom.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_RANDOM_H
+#define INCLUDED_XENGINE_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace X {
+
+// PCG32 (XSH RR). 16 bytes of state, so systems can own their stream instead of sharing a global one.
+// Generators with the same seed but a different stream id produce unrelated sequences, which is how
+// threads or simulated objects get their own deterministic numbers.
+class RandomStream
+{
+public:
+	RandomStream()													{ Seed(0x853c49e6748fea9bull, 0); }
+	RandomStream(uint64_t seed, uint64_t stream = 0)				{ Seed(seed, stream); }
+
+	void Seed(uint64_t seed, uint64_t stream = 0)
+	{
+		mState = 0;
+		mIncrement = (stream << 1) | 1;
+		Next();
+		mState += seed;
+		Next();
+	}
+
+	uint32_t Next()
+	{
+		const uint64_t old = mState;
+		mState = old * kMultiplier + mIncrement;
+		const uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+		const uint32_t rotation = static_cast<uint32_t>(old >> 59);
+		return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+	}
+
+	// Unbiased in [0, bound), bound must not be 0
+	uint32_t Next(uint32_t bound)
+	{
+		uint64_t product = static_cast<uint64_t>(Next()) * bound;
+		uint32_t low = static_cast<uint32_t>(product);
+		if (low < bound)
+		{
+			const uint32_t threshold = (0u - bound) % bound;
+			while (low < threshold)
+			{
+				product = static_cast<uint64_t>(Next()) * bound;
+				low = static_cast<uint32_t>(product);
+			}
+		}
+		return static_cast<uint32_t>(product >> 32);
+	}
+
+	// Inclusive on both ends
+	int Range(int min, int max)
+	{
+		const uint32_t span = static_cast<uint32_t>(static_cast<int64_t>(max) - min + 1);
+		return static_cast<int>(static_cast<int64_t>(min) + (span == 0 ? Next() : Next(span)));
+	}
+
+	// [0, 1) with 24 bits of precision
+	float NextFloat()												{ return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f); }
+	float Range(float min, float max)								{ return min + (max - min) * NextFloat(); }
+	bool NextBool()													{ return (Next() >> 31) != 0; }
+
+	// Bulk versions, same sequence as calling Next/NextFloat count times
+	void Fill(uint32_t* values, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = Next();
+		}
+	}
+	void Fill(float* values, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = NextFloat();
+		}
+	}
+
+	// Skips ahead as if Next had been called delta times, in log2(delta) steps
+	void Advance(uint64_t delta)
+	{
+		uint64_t multiplier = kMultiplier;
+		uint64_t increment = mIncrement;
+		uint64_t accumulatedMultiplier = 1;
+		uint64_t accumulatedIncrement = 0;
+		while (delta > 0)
+		{
+			if (delta & 1)
+			{
+				accumulatedMultiplier *= multiplier;
+				accumulatedIncrement = accumulatedIncrement * multiplier + increment;
+			}
+			increment = (multiplier + 1) * increment;
+			multiplier *= multiplier;
+			delta >>= 1;
+		}
+		mState = accumulatedMultiplier * mState + accumulatedIncrement;
+	}
+
+private:
+	static constexpr uint64_t kMultiplier = 6364136223846793005ull;
+
+	uint64_t mState;
+	uint64_t mIncrement;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_RANDOM_H
@@ -9,7 +9,10 @@
 namespace X {
 
 using SoundId = std::size_t;
-using TextureId = std::size_t;
+
+// Generational handle, the low bits index a texture slot and the high bits hold the slot generation.
+// 0 is never a valid texture.
+using TextureId = uint32_t;
 
 enum class Pivot
 {
@@ -32,25 +35,85 @@ enum class Flip
 	Both
 };
 
+// Config value resolved once from its key, see X::ConfigFindFloat. Reading is a single load and sees
+// the latest value after a hot reload. Handles are valid until X::Stop.
+template <class T>
+struct ConfigHandle
+{
+	const T* value = nullptr;
+
+	T Get() const { return *value; }
+};
+
+using ConfigInt = ConfigHandle<int>;
+using ConfigBool = ConfigHandle<bool>;
+using ConfigFloat = ConfigHandle<float>;
+
+// Counters gathered by the engine over one frame, times are in milliseconds
+struct FrameStats
+{
+	uint64_t frame = 0;
+	float frameTime = 0.0f;
+	float simulationTime = 0.0f;
+	float renderTime = 0.0f;
+	uint32_t spriteCommands = 0;
+	uint32_t textureChanges = 0;
+	uint32_t textCommands = 0;
+	uint32_t vertices2D = 0;
+	uint32_t vertices3D = 0;
+	uint32_t audioVoices = 0;
+	uint32_t allocations = 0;
+};
+
+// Jobs run a function pointer with a user pointer, see X::RunJob. Range jobs get a slice of
+// [0, count) from X::ParallelFor.
+using JobFunction = void (*)(void* data);
+using JobRangeFunction = void (*)(void* data, uint32_t begin, uint32_t end);
+
+struct Job;
+
+// Number of unfinished jobs scheduled with it. Jobs scheduled to run after a counter start when it
+// reaches 0. A counter is done once no job is pending and no finishing job still touches it, so it
+// can be destroyed or reused as soon as IsDone returns true.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const	{ return mState.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	// Pending jobs in the low 32 bits, jobs inside Finish in the high 32 bits
+	std::atomic<uint64_t> mState{ 0 };
+	std::atomic<Job*> mWaiting{ nullptr };
+};
+
 namespace Keys {
 
+// Values match the Win32 virtual key codes, other platforms translate their key events to these
+
 // Keyboard roll 1
-const int ESCAPE		= VK_ESCAPE;
-const int F1			= VK_F1;
-const int F2			= VK_F2;
-const int F3			= VK_F3;
-const int F4			= VK_F4;
-const int F5			= VK_F5;
-const int F6			= VK_F6;
-const int F7			= VK_F7;
-const int F8			= VK_F8;
-const int F9			= VK_F9;
-const int F10			= VK_F10;
-const int F11			= VK_F11;
-const int F12			= VK_F12;
+const int ESCAPE		= 0x1b;
+const int F1			= 0x70;
+const int F2			= 0x71;
+const int F3			= 0x72;
+const int F4			= 0x73;
+const int F5			= 0x74;
+const int F6			= 0x75;
+const int F7			= 0x76;
+const int F8			= 0x77;
+const int F9			= 0x78;
+const int F10			= 0x79;
+const int F11			= 0x7a;
+const int F12			= 0x7b;
 
 // Keyboard roll 2
-const int GRAVE			= VK_OEM_3;
+const int GRAVE			= 0xc0;
 const int ONE			= '1';
 const int TWO			= '2';
 const int THREE			= '3';
@@ -61,12 +124,12 @@ const int SEVEN			= '7';
 const int EIGHT			= '8';
 const int NINE			= '9';
 const int ZERO			= '0';
-const int MINUS			= VK_OEM_MINUS;
-const int EQUALS		= VK_OEM_PLUS;
-const int BACKSPACE		= VK_BACK;
+const int MINUS			= 0xbd;
+const int EQUALS		= 0xbb;
+const int BACKSPACE		= 0x08;
 
 // Keyboard roll 3
-const int TAB			= VK_TAB;
+const int TAB			= 0x09;
 const int Q				= 'Q';
 const int W				= 'W';
 const int E				= 'E';
@@ -77,9 +140,9 @@ const int U				= 'U';
 const int I				= 'I';
 const int O				= 'O';
 const int P				= 'P';
-const int LBRACKET		= VK_OEM_4;
-const int RBRACKET		= VK_OEM_6;
-const int BACKSLASH		= VK_OEM_5;
+const int LBRACKET		= 0xdb;
+const int RBRACKET		= 0xdd;
+const int BACKSLASH		= 0xdc;
 
 // Keyboard roll 4
 const int A				= 'A';
@@ -91,9 +154,9 @@ const int H				= 'H';
 const int J				= 'J';
 const int K				= 'K';
 const int L				= 'L';
-const int SEMICOLON		= VK_OEM_1;
-const int APOSTROPHE	= VK_OEM_7;
-const int ENTER			= VK_RETURN;
+const int SEMICOLON		= 0xba;
+const int APOSTROPHE	= 0xde;
+const int ENTER			= 0x0d;
 
 // Keyboard roll 5
 const int Z				= 'Z';
@@ -103,57 +166,57 @@ const int V				= 'V';
 const int B				= 'B';
 const int N				= 'N';
 const int M				= 'M';
-const int COMMA			= VK_OEM_COMMA;
-const int PERIOD		= VK_OEM_PERIOD;
-const int SLASH			= VK_OEM_2;
+const int COMMA			= 0xbc;
+const int PERIOD		= 0xbe;
+const int SLASH			= 0xbf;
 
 // Lock keys
-const int CAPSLOCK		= VK_CAPITAL;
-const int NUMLOCK		= VK_NUMLOCK;
-const int SCROLLLOCK	= VK_SCROLL;
+const int CAPSLOCK		= 0x14;
+const int NUMLOCK		= 0x90;
+const int SCROLLLOCK	= 0x91;
 
 // Numpad
-const int NUMPAD1		= VK_NUMPAD1;
-const int NUMPAD2		= VK_NUMPAD2;
-const int NUMPAD3		= VK_NUMPAD3;
-const int NUMPAD4		= VK_NUMPAD4;
-const int NUMPAD5		= VK_NUMPAD5;
-const int NUMPAD6		= VK_NUMPAD6;
-const int NUMPAD7		= VK_NUMPAD7;
-const int NUMPAD8		= VK_NUMPAD8;
-const int NUMPAD9		= VK_NUMPAD9;
-const int NUMPAD0		= VK_NUMPAD0;
-const int NUM_ADD		= VK_ADD;
-const int NUM_SUB		= VK_SUBTRACT;
-const int NUM_MUL		= VK_MULTIPLY;
-const int NUM_DIV		= VK_DIVIDE;
-const int NUM_ENTER		= VK_RETURN;
-const int NUM_DECIMAL	= VK_DECIMAL;
+const int NUMPAD1		= 0x61;
+const int NUMPAD2		= 0x62;
+const int NUMPAD3		= 0x63;
+const int NUMPAD4		= 0x64;
+const int NUMPAD5		= 0x65;
+const int NUMPAD6		= 0x66;
+const int NUMPAD7		= 0x67;
+const int NUMPAD8		= 0x68;
+const int NUMPAD9		= 0x69;
+const int NUMPAD0		= 0x60;
+const int NUM_ADD		= 0x6b;
+const int NUM_SUB		= 0x6d;
+const int NUM_MUL		= 0x6a;
+const int NUM_DIV		= 0x6f;
+const int NUM_ENTER		= 0x0d;
+const int NUM_DECIMAL	= 0x6e;
 
 // Navigation keys
-const int INS			= VK_INSERT;
-const int DEL			= VK_DELETE;
-const int HOME			= VK_HOME;
-const int END			= VK_END;
-const int PGUP			= VK_PRIOR;
-const int PGDN			= VK_NEXT;
+const int INS			= 0x2d;
+const int DEL			= 0x2e;
+const int HOME			= 0x24;
+const int END			= 0x23;
+const int PGUP			= 0x21;
+const int PGDN			= 0x22;
 
 // Support keys
-const int LSHIFT		= VK_SHIFT;
-const int RSHIFT		= VK_SHIFT;
-const int LCONTROL		= VK_CONTROL;
-const int RCONTROL		= VK_CONTROL;
-const int LALT			= VK_MENU;
-const int RALT			= VK_MENU;
-const int LWIN			= VK_LWIN;
-const int RWIN			= VK_RWIN;
-const int SPACE			= VK_SPACE;
+const int LSHIFT		= 0x10;
+const int RSHIFT		= 0x10;
+const int LCONTROL		= 0x11;
+const int RCONTROL		= 0x11;
+const int LALT			= 0x12;
+const int RALT			= 0x12;
+const int LWIN			= 0x5b;
+const int RWIN			= 0x5c;
+const int SPACE			= 0x20;
 
 // Arrow keys
-const int UP			= VK_UP;
-const int DOWN			= VK_DOWN;
-const int LEFT			= VK_LEFT;
-const int RIGHT			= VK_RIGHT;
+const int UP			= 0x26;
+const int DOWN			= 0x28;
+const int LEFT			= 0x25;
+const int RIGHT			= 0x27;
 
 } // namespace Keys
 
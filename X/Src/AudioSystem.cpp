@@ -90,4 +90,17 @@ void AudioSystem::Update()
 			SafeDelete(mAudioEngine);
 		}
 	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t AudioSystem::GetPlayingVoiceCount() const
+{
+	if (mAudioEngine == nullptr)
+	{
+		return 0;
+	}
+
+	const AudioStatistics stats = mAudioEngine->GetStatistics();
+	return static_cast<uint32_t>(stats.playingOneShots + stats.playingInstances);
 }
\ No newline at end of file
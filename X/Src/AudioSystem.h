@@ -29,6 +29,8 @@ public:
 
 	void Update();
 
+	uint32_t GetPlayingVoiceCount() const;
+
 private:
 	friend class SoundEffectManager;
 	
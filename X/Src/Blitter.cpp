@@ -0,0 +1,159 @@
+//====================================================================================================
+// Filename:	Blitter.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "Blitter.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define XBLITTER_AVX2
+#endif
+#if defined(_M_X64) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define XBLITTER_SSE2
+#endif
+
+using namespace X;
+
+namespace
+{
+	constexpr uint32_t kGatherSize = 256;
+
+#if defined(XBLITTER_SSE2)
+	// 16 bit lanes holding two pixels' channels, blended against the alpha broadcast into every lane
+	inline __m128i Blend16(__m128i src, __m128i dst, __m128i alpha)
+	{
+		const __m128i k255 = _mm_set1_epi16(255);
+		const __m128i k128 = _mm_set1_epi16(128);
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, _mm_sub_epi16(k255, alpha)));
+		x = _mm_add_epi16(x, k128);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	inline __m128i BroadcastAlpha(__m128i channels)
+	{
+		const __m128i lo = _mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3));
+		return _mm_shufflehi_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	inline __m128i Blend4(__m128i src, __m128i dst)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero);
+		const __m128i srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i lo = Blend16(srcLo, _mm_unpacklo_epi8(dst, zero), BroadcastAlpha(srcLo));
+		const __m128i hi = Blend16(srcHi, _mm_unpackhi_epi8(dst, zero), BroadcastAlpha(srcHi));
+		return _mm_packus_epi16(lo, hi);
+	}
+#endif
+
+#if defined(XBLITTER_AVX2)
+	inline __m256i Blend16(__m256i src, __m256i dst, __m256i alpha)
+	{
+		const __m256i k255 = _mm256_set1_epi16(255);
+		const __m256i k128 = _mm256_set1_epi16(128);
+		__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dst, _mm256_sub_epi16(k255, alpha)));
+		x = _mm256_add_epi16(x, k128);
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	inline __m256i BroadcastAlpha(__m256i channels)
+	{
+		const __m256i lo = _mm256_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3));
+		return _mm256_shufflehi_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	// Unpack and pack both work per 128 bit lane, so pixel order is preserved
+	inline __m256i Blend8(__m256i src, __m256i dst)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i srcLo = _mm256_unpacklo_epi8(src, zero);
+		const __m256i srcHi = _mm256_unpackhi_epi8(src, zero);
+		const __m256i lo = Blend16(srcLo, _mm256_unpacklo_epi8(dst, zero), BroadcastAlpha(srcLo));
+		const __m256i hi = Blend16(srcHi, _mm256_unpackhi_epi8(dst, zero), BroadcastAlpha(srcHi));
+		return _mm256_packus_epi16(lo, hi);
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Blitter::BlendSpan(const uint32_t* src, uint32_t* dst, uint32_t count)
+{
+	uint32_t i = 0;
+
+#if defined(XBLITTER_AVX2)
+	const __m256i alphaMask256 = _mm256_set1_epi32(static_cast<int>(0xff000000));
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		const __m256i alpha = _mm256_and_si256(s, alphaMask256);
+		const int opaque = _mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alphaMask256));
+		if (opaque == -1)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+			continue;
+		}
+		if (_mm256_testz_si256(alpha, alpha))
+		{
+			continue;
+		}
+		const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Blend8(s, d));
+	}
+#endif
+
+#if defined(XBLITTER_SSE2)
+	// Whole groups of opaque or transparent texels are common in sprites, skip the math for those
+	const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000));
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i alpha = _mm_and_si128(s, alphaMask);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xffff)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xffff)
+		{
+			continue;
+		}
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Blend4(s, d));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = BlendPixel(src[i], dst[i]);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Blitter::BlendSpan(const uint32_t* src, ptrdiff_t srcStep, uint32_t* dst, uint32_t count)
+{
+	if (srcStep == 1)
+	{
+		BlendSpan(src, dst, count);
+		return;
+	}
+
+	// Gather into a contiguous block first so the blend itself stays vectorized
+	uint32_t gathered[kGatherSize];
+	while (count > 0)
+	{
+		const uint32_t size = std::min(count, kGatherSize);
+		for (uint32_t i = 0; i < size; ++i, src += srcStep)
+		{
+			gathered[i] = *src;
+		}
+		BlendSpan(gathered, dst, size);
+		dst += size;
+		count -= size;
+	}
+}
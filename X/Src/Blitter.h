@@ -0,0 +1,63 @@
+//====================================================================================================
+// Filename:	Blitter.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_BLITTER_H
+#define INCLUDED_XENGINE_BLITTER_H
+
+namespace X {
+namespace Blitter {
+
+// Pixels are RGBA8 in memory, which reads as 0xAABBGGRR on little endian. Blending matches the non
+// premultiplied blend state: every channel (alpha included) is src * a + dst * (1 - a).
+inline uint32_t Div255(uint32_t x)
+{
+	// Exact x / 255 rounded to nearest for x in [0, 255 * 255]
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+inline uint32_t BlendPixel(uint32_t src, uint32_t dst)
+{
+	const uint32_t a = src >> 24;
+	if (a == 255)
+	{
+		return src;
+	}
+	if (a == 0)
+	{
+		return dst;
+	}
+	const uint32_t ia = 255 - a;
+	const uint32_t r = Div255((src & 0xff) * a + (dst & 0xff) * ia);
+	const uint32_t g = Div255(((src >> 8) & 0xff) * a + ((dst >> 8) & 0xff) * ia);
+	const uint32_t b = Div255(((src >> 16) & 0xff) * a + ((dst >> 16) & 0xff) * ia);
+	const uint32_t da = Div255(a * a + (dst >> 24) * ia);
+	return r | (g << 8) | (b << 16) | (da << 24);
+}
+
+// Per channel src * color / 255, used to tint sprites and glyphs
+inline uint32_t Modulate(uint32_t src, uint32_t color)
+{
+	if (color == 0xffffffff)
+	{
+		return src;
+	}
+	const uint32_t r = Div255((src & 0xff) * (color & 0xff));
+	const uint32_t g = Div255(((src >> 8) & 0xff) * ((color >> 8) & 0xff));
+	const uint32_t b = Div255(((src >> 16) & 0xff) * ((color >> 16) & 0xff));
+	const uint32_t a = Div255((src >> 24) * (color >> 24));
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// Blends count contiguous pixels, SSE2/AVX2 when available. Results are bit identical to BlendPixel.
+void BlendSpan(const uint32_t* src, uint32_t* dst, uint32_t count);
+
+// Same as BlendSpan but reads src with a stride in pixels, used for flipped and quarter turned sprites
+void BlendSpan(const uint32_t* src, ptrdiff_t srcStep, uint32_t* dst, uint32_t count);
+
+} // namespace Blitter
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_BLITTER_H
@@ -0,0 +1,46 @@
+//====================================================================================================
+// Filename:	Clock.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "Clock.h"
+
+using namespace X;
+
+//----------------------------------------------------------------------------------------------------
+
+RealClock* RealClock::Get()
+{
+	static RealClock sInstance;
+	return &sInstance;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t RealClock::GetTicks() const
+{
+	return Platform::GetClockTicks();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t RealClock::GetFrequency() const
+{
+	return Platform::GetClockFrequency();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ManualClock::Advance(float seconds)
+{
+	XASSERT(seconds >= 0.0f, "[ManualClock] Time can only move forward.");
+	mTicks += static_cast<uint64_t>(static_cast<double>(seconds) * kFrequency + 0.5);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ManualClock::AdvanceTicks(uint64_t ticks)
+{
+	mTicks += ticks;
+}
@@ -0,0 +1,49 @@
+//====================================================================================================
+// Filename:	Clock.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_CLOCK_H
+#define INCLUDED_XENGINE_CLOCK_H
+
+namespace X {
+
+// Time source read by Timer. Ticks only have to be monotonic, GetFrequency is ticks per second.
+class Clock
+{
+public:
+	virtual ~Clock() = default;
+
+	virtual uint64_t GetTicks() const = 0;
+	virtual uint64_t GetFrequency() const = 0;
+};
+
+// The platform's high resolution clock, shared since it has no state
+class RealClock : public Clock
+{
+public:
+	static RealClock* Get();
+
+	uint64_t GetTicks() const override;
+	uint64_t GetFrequency() const override;
+};
+
+// Only moves when told to, for tests and fixed step runs that should not wait on wall clock time
+class ManualClock : public Clock
+{
+public:
+	void Advance(float seconds);
+	void AdvanceTicks(uint64_t ticks);
+
+	uint64_t GetTicks() const override		{ return mTicks; }
+	uint64_t GetFrequency() const override	{ return kFrequency; }
+
+private:
+	static constexpr uint64_t kFrequency = 1000000000;
+
+	uint64_t mTicks = 0;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_CLOCK_H
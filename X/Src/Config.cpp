@@ -7,15 +7,48 @@
 #include "Config.h"
 
 #include <RapidJSON/Inc/document.h>
-#include <RapidJSON/Inc/filereadstream.h>
-#include <RapidJSON/Inc/filewritestream.h>
 #include <RapidJSON/Inc/prettywriter.h>
+#include <RapidJSON/Inc/stringbuffer.h>
 
 using namespace X;
 
 namespace
 {
 	Config* sConfig = nullptr;
+
+	// Room for every key the game resolves to a handle, slots never move so handles stay valid
+	constexpr uint32_t kMaxKeys = 256;
+
+	// How often a watched file is checked for changes, in seconds
+	constexpr float kWatchInterval = 0.25f;
+
+	std::unique_ptr<rapidjson::Document> ParseFile(const char* fileName)
+	{
+		FILE* file = Platform::OpenFile(fileName, "rb");
+		if (file == nullptr)
+		{
+			return nullptr;
+		}
+
+		// Read the whole file, sized to fit
+		std::string text;
+		char buffer[4096];
+		size_t read = 0;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			text.append(buffer, read);
+		}
+		fclose(file);
+
+		auto document = std::make_unique<rapidjson::Document>();
+		document->Parse(text.c_str(), text.size());
+		if (document->HasParseError() || !document->IsObject())
+		{
+			XLOG("[Config] Failed to parse %s, error %d at offset %zu.", fileName, static_cast<int>(document->GetParseError()), document->GetErrorOffset());
+			return nullptr;
+		}
+		return document;
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -27,19 +60,61 @@ public:
 	void Save();
 	void SaveAs(const char* fileName);
 
-	int GetInt(const char* key, int default = 0) const;
-	bool GetBool(const char* key, bool default = false) const;
-	float GetFloat(const char* key, float default = 0.0f) const;
-	const char* GetString(const char* key, const char* default = "") const;
+	int GetInt(const char* key, int defaultValue = 0) const;
+	bool GetBool(const char* key, bool defaultValue = false) const;
+	float GetFloat(const char* key, float defaultValue = 0.0f) const;
+	const char* GetString(const char* key, const char* defaultValue = "") const;
 
 	void SetInt(const char* key, int value);
 	void SetBool(const char* key, bool value);
 	void SetFloat(const char* key, float value);
 	void SetString(const char* key, const char* value);
 
+	ConfigInt FindInt(const char* key, int defaultValue);
+	ConfigBool FindBool(const char* key, bool defaultValue);
+	ConfigFloat FindFloat(const char* key, float defaultValue);
+
+	void SetHotReload(bool enable);
+	void Update();
+
 private:
-	rapidjson::Document mDocument;
+	enum class Type { Int, Bool, Float };
+
+	struct Key
+	{
+		std::string name;
+		Type type;
+		uint32_t slot;
+		int intDefault;
+		bool boolDefault;
+		float floatDefault;
+	};
+
+	const Key* FindKey(const char* key, Type type) const;
+	Key& AddKey(const char* key, Type type);
+	void Refresh(const Key& key);
+	void RefreshAll();
+	void Swap(std::unique_ptr<rapidjson::Document> document);
+
+	std::unique_ptr<rapidjson::Document> mDocument = std::make_unique<rapidjson::Document>();
 	std::string mFileName;
+
+	// Replaced documents are kept until the next Update so strings handed out by GetString stay valid
+	// for the rest of the frame
+	std::vector<std::unique_ptr<rapidjson::Document>> mRetired;
+
+	std::vector<Key> mKeys;
+	std::array<int, kMaxKeys> mInts{};
+	std::array<bool, kMaxKeys> mBools{};
+	std::array<float, kMaxKeys> mFloats{};
+	uint32_t mIntCount = 0;
+	uint32_t mBoolCount = 0;
+	uint32_t mFloatCount = 0;
+
+	bool mHotReload = false;
+	uint64_t mFileSize = 0;
+	uint64_t mFileTime = 0;
+	uint64_t mNextCheck = 0;
 };
 
 //----------------------------------------------------------------------------------------------------
@@ -52,21 +127,16 @@ void Config::Impl::Load(const char* fileName)
 		return;
 	}
 
-	FILE* file = nullptr;
-	fopen_s(&file, fileName, "rb");
-	if (file == nullptr)
+	std::unique_ptr<rapidjson::Document> document = ParseFile(fileName);
+	if (document == nullptr)
 	{
-		XLOG("[Config] Failed to open config file %s. Default settings will be used.", fileName);
+		XLOG("[Config] Failed to load config file %s. Default settings will be used.", fileName);
 		return;
 	}
 
-	char buffer[65536];
-	rapidjson::FileReadStream readStream(file, buffer, std::size(buffer));
-	mDocument.ParseStream(readStream);
-
-	fclose(file);
-
 	mFileName = fileName;
+	Platform::GetFileStamp(fileName, mFileSize, mFileTime);
+	Swap(std::move(document));
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -80,105 +150,116 @@ void Config::Impl::Save()
 
 void Config::Impl::SaveAs(const char* fileName)
 {
-	FILE* file = nullptr;
-	fopen_s(&file, fileName, "wb");
+	FILE* file = Platform::OpenFile(fileName, "wb");
 	if (file == nullptr)
 	{
 		XLOG("[Config] Failed to save config file %s.", fileName);
 		return;
 	}
 
-	char buffer[65536];
-	rapidjson::FileWriteStream writeStream(file, buffer, std::size(buffer));
-	rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(writeStream);
-	mDocument.Accept(writer);
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+	mDocument->Accept(writer);
+	fwrite(buffer.GetString(), 1, buffer.GetSize(), file);
 
 	fclose(file);
+
+	// Don't reload our own write
+	if (mFileName == fileName)
+	{
+		Platform::GetFileStamp(fileName, mFileSize, mFileTime);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
 
-int Config::Impl::GetInt(const char* key, int default) const
+int Config::Impl::GetInt(const char* key, int defaultValue) const
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		return default;
+		return defaultValue;
 	}
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd() && iter->value.IsInt())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd() && iter->value.IsInt())
 	{
 		return iter->value.GetInt();
 	}
-	return default;
+	return defaultValue;
 }
 
 //----------------------------------------------------------------------------------------------------
 
-bool Config::Impl::GetBool(const char* key, bool default) const
+bool Config::Impl::GetBool(const char* key, bool defaultValue) const
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		return default;
+		return defaultValue;
 	}
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd() && iter->value.IsBool())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd() && iter->value.IsBool())
 	{
 		return iter->value.GetBool();
 	}
-	return default;
+	return defaultValue;
 }
 
 //----------------------------------------------------------------------------------------------------
 
-float Config::Impl::GetFloat(const char* key, float default) const
+float Config::Impl::GetFloat(const char* key, float defaultValue) const
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		return default;
+		return defaultValue;
 	}
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd() && iter->value.IsFloat())
+	auto iter = mDocument->FindMember(key);
+	// Whole numbers in the file are fine for floats too
+	if (iter != mDocument->MemberEnd() && iter->value.IsNumber())
 	{
-		return iter->value.GetFloat();
+		return static_cast<float>(iter->value.GetDouble());
 	}
-	return default;
+	return defaultValue;
 }
 
 //----------------------------------------------------------------------------------------------------
 
-const char* Config::Impl::GetString(const char* key, const char* default) const
+const char* Config::Impl::GetString(const char* key, const char* defaultValue) const
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		return default;
+		return defaultValue;
 	}
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd() && iter->value.IsString())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd() && iter->value.IsString())
 	{
 		return iter->value.GetString();
 	}
-	return default;
+	return defaultValue;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void Config::Impl::SetInt(const char* key, int value)
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		mDocument.StartObject();
+		mDocument->SetObject();
 	}
 
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd())
 	{
 		XASSERT(iter->value.IsInt(), "[Config] %s is not an integer.", key);
 		iter->value.SetInt(value);
 	}
 	else
 	{
-		rapidjson::Value k(key, mDocument.GetAllocator());
-		mDocument.AddMember(k, value, mDocument.GetAllocator());
+		rapidjson::Value k(key, mDocument->GetAllocator());
+		mDocument->AddMember(k, value, mDocument->GetAllocator());
+	}
+
+	if (const Key* handle = FindKey(key, Type::Int))
+	{
+		Refresh(*handle);
 	}
 }
 
@@ -186,21 +267,26 @@ void Config::Impl::SetInt(const char* key, int value)
 
 void Config::Impl::SetBool(const char* key, bool value)
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		mDocument.StartObject();
+		mDocument->SetObject();
 	}
 
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd())
 	{
 		XASSERT(iter->value.IsBool(), "[Config] %s is not a boolean.", key);
 		iter->value.SetBool(value);
 	}
 	else
 	{
-		rapidjson::Value k(key, mDocument.GetAllocator());
-		mDocument.AddMember(k, value, mDocument.GetAllocator());
+		rapidjson::Value k(key, mDocument->GetAllocator());
+		mDocument->AddMember(k, value, mDocument->GetAllocator());
+	}
+
+	if (const Key* handle = FindKey(key, Type::Bool))
+	{
+		Refresh(*handle);
 	}
 }
 
@@ -208,21 +294,26 @@ void Config::Impl::SetBool(const char* key, bool value)
 
 void Config::Impl::SetFloat(const char* key, float value)
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		mDocument.StartObject();
+		mDocument->SetObject();
 	}
 
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd())
 	{
-		XASSERT(iter->value.IsFloat(), "[Config] %s is not a float.", key);
+		XASSERT(iter->value.IsNumber(), "[Config] %s is not a number.", key);
 		iter->value.SetFloat(value);
 	}
 	else
 	{
-		rapidjson::Value k(key, mDocument.GetAllocator());
-		mDocument.AddMember(k, value, mDocument.GetAllocator());
+		rapidjson::Value k(key, mDocument->GetAllocator());
+		mDocument->AddMember(k, value, mDocument->GetAllocator());
+	}
+
+	if (const Key* handle = FindKey(key, Type::Float))
+	{
+		Refresh(*handle);
 	}
 }
 
@@ -230,24 +321,190 @@ void Config::Impl::SetFloat(const char* key, float value)
 
 void Config::Impl::SetString(const char* key, const char* value)
 {
-	if (!mDocument.IsObject())
+	if (!mDocument->IsObject())
 	{
-		mDocument.StartObject();
+		mDocument->SetObject();
 	}
 
-	rapidjson::Value v(value, mDocument.GetAllocator());
+	rapidjson::Value v(value, mDocument->GetAllocator());
 
-	auto iter = mDocument.FindMember(key);
-	if (iter != mDocument.MemberEnd())
+	auto iter = mDocument->FindMember(key);
+	if (iter != mDocument->MemberEnd())
 	{
 		XASSERT(iter->value.IsString(), "[Config] %s is not a boolean.", key);
 		iter->value.SetString(value, (rapidjson::SizeType)std::strlen(value));
 	}
 	else
 	{
-		rapidjson::Value k(key, mDocument.GetAllocator());
-		mDocument.AddMember(k, v, mDocument.GetAllocator());
+		rapidjson::Value k(key, mDocument->GetAllocator());
+		mDocument->AddMember(k, v, mDocument->GetAllocator());
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigInt Config::Impl::FindInt(const char* key, int defaultValue)
+{
+	const Key* found = FindKey(key, Type::Int);
+	if (found == nullptr)
+	{
+		Key& added = AddKey(key, Type::Int);
+		added.intDefault = defaultValue;
+		Refresh(added);
+		found = &added;
+	}
+	else
+	{
+		XASSERT(found->intDefault == defaultValue, "[Config] %s was already found with a different default.", key);
 	}
+	return { &mInts[found->slot] };
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigBool Config::Impl::FindBool(const char* key, bool defaultValue)
+{
+	const Key* found = FindKey(key, Type::Bool);
+	if (found == nullptr)
+	{
+		Key& added = AddKey(key, Type::Bool);
+		added.boolDefault = defaultValue;
+		Refresh(added);
+		found = &added;
+	}
+	else
+	{
+		XASSERT(found->boolDefault == defaultValue, "[Config] %s was already found with a different default.", key);
+	}
+	return { &mBools[found->slot] };
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigFloat Config::Impl::FindFloat(const char* key, float defaultValue)
+{
+	const Key* found = FindKey(key, Type::Float);
+	if (found == nullptr)
+	{
+		Key& added = AddKey(key, Type::Float);
+		added.floatDefault = defaultValue;
+		Refresh(added);
+		found = &added;
+	}
+	else
+	{
+		XASSERT(found->floatDefault == defaultValue, "[Config] %s was already found with a different default.", key);
+	}
+	return { &mFloats[found->slot] };
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Impl::SetHotReload(bool enable)
+{
+	mHotReload = enable;
+	mNextCheck = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Impl::Update()
+{
+	// Update runs at the start of a frame, nothing from the last one still holds a retired string
+	mRetired.clear();
+
+	if (!mHotReload || mFileName.empty())
+	{
+		return;
+	}
+
+	// Only touch the file system a few times a second
+	const uint64_t now = Platform::GetClockTicks();
+	if (now < mNextCheck)
+	{
+		return;
+	}
+	mNextCheck = now + static_cast<uint64_t>(Platform::GetClockFrequency() * kWatchInterval);
+
+	uint64_t fileSize = 0, fileTime = 0;
+	if (!Platform::GetFileStamp(mFileName.c_str(), fileSize, fileTime) || (fileSize == mFileSize && fileTime == mFileTime))
+	{
+		return;
+	}
+	mFileSize = fileSize;
+	mFileTime = fileTime;
+
+	// A file caught half written fails to parse and the current values stay, the finished write changes
+	// the stamp again and is picked up then
+	std::unique_ptr<rapidjson::Document> document = ParseFile(mFileName.c_str());
+	if (document == nullptr)
+	{
+		return;
+	}
+	Swap(std::move(document));
+	XLOG("[Config] Reloaded %s.", mFileName.c_str());
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const Config::Impl::Key* Config::Impl::FindKey(const char* key, Type type) const
+{
+	for (const Key& k : mKeys)
+	{
+		if (k.type == type && k.name == key)
+		{
+			return &k;
+		}
+	}
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Config::Impl::Key& Config::Impl::AddKey(const char* key, Type type)
+{
+	uint32_t& count = type == Type::Int ? mIntCount : (type == Type::Bool ? mBoolCount : mFloatCount);
+	XASSERT(count < kMaxKeys, "[Config] Too many handles, failed to add %s.", key);
+	mKeys.push_back({ key, type, count++, 0, false, 0.0f });
+	return mKeys.back();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Impl::Refresh(const Key& key)
+{
+	switch (key.type)
+	{
+	case Type::Int:
+		mInts[key.slot] = GetInt(key.name.c_str(), key.intDefault);
+		break;
+	case Type::Bool:
+		mBools[key.slot] = GetBool(key.name.c_str(), key.boolDefault);
+		break;
+	case Type::Float:
+		mFloats[key.slot] = GetFloat(key.name.c_str(), key.floatDefault);
+		break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Impl::RefreshAll()
+{
+	for (const Key& key : mKeys)
+	{
+		Refresh(key);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Impl::Swap(std::unique_ptr<rapidjson::Document> document)
+{
+	// The new document is complete before anything sees it, then every slot is rewritten in one go
+	mRetired.push_back(std::move(mDocument));
+	mDocument = std::move(document);
+	RefreshAll();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -286,6 +543,10 @@ Config::Config()
 
 //----------------------------------------------------------------------------------------------------
 
+Config::~Config() = default;
+
+//----------------------------------------------------------------------------------------------------
+
 void Config::Load(const char* fileName)
 {
 	mImpl->Load(fileName);
@@ -307,30 +568,30 @@ void Config::SaveAs(const char* fileName)
 
 //----------------------------------------------------------------------------------------------------
 
-int Config::GetInt(const char* key, int default) const
+int Config::GetInt(const char* key, int defaultValue) const
 {
-	return mImpl->GetInt(key, default);
+	return mImpl->GetInt(key, defaultValue);
 }
 
 //----------------------------------------------------------------------------------------------------
 
-bool Config::GetBool(const char* key, bool default) const
+bool Config::GetBool(const char* key, bool defaultValue) const
 {
-	return mImpl->GetBool(key, default);
+	return mImpl->GetBool(key, defaultValue);
 }
 
 //----------------------------------------------------------------------------------------------------
 
-float Config::GetFloat(const char* key, float default) const
+float Config::GetFloat(const char* key, float defaultValue) const
 {
-	return mImpl->GetFloat(key, default);
+	return mImpl->GetFloat(key, defaultValue);
 }
 
 //----------------------------------------------------------------------------------------------------
 
-const char* Config::GetString(const char* key, const char* default) const
+const char* Config::GetString(const char* key, const char* defaultValue) const
 {
-	return mImpl->GetString(key, default);
+	return mImpl->GetString(key, defaultValue);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -358,4 +619,39 @@ void Config::SetFloat(const char* key, float value)
 void Config::SetString(const char* key, const char* value)
 {
 	mImpl->SetString(key, value);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigInt Config::FindInt(const char* key, int defaultValue)
+{
+	return mImpl->FindInt(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigBool Config::FindBool(const char* key, bool defaultValue)
+{
+	return mImpl->FindBool(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigFloat Config::FindFloat(const char* key, float defaultValue)
+{
+	return mImpl->FindFloat(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::SetHotReload(bool enable)
+{
+	mImpl->SetHotReload(enable);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Config::Update()
+{
+	mImpl->Update();
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 #ifndef	INCLUDED_XENGINE_CONFIG_H
 #define INCLUDED_XENGINE_CONFIG_H
 
+#include "XTypes.h"
+
 namespace X {
 
 class Config
@@ -17,21 +19,34 @@ public:
 
 public:
 	Config();
+	~Config();
 
 	void Load(const char* fileName);
 	void Save();
 	void SaveAs(const char* fileName);
 
-	int GetInt(const char* key, int default = 0) const;
-	bool GetBool(const char* key, bool default = false) const;
-	float GetFloat(const char* key, float default = 0.0f) const;
-	const char* GetString(const char* key, const char* default = "") const;
+	int GetInt(const char* key, int defaultValue = 0) const;
+	bool GetBool(const char* key, bool defaultValue = false) const;
+	float GetFloat(const char* key, float defaultValue = 0.0f) const;
+	const char* GetString(const char* key, const char* defaultValue = "") const;
 	
 	void SetInt(const char* key, int value);
 	void SetBool(const char* key, bool value);
 	void SetFloat(const char* key, float value);
 	void SetString(const char* key, const char* value);
 
+	// Resolves a key once to a slot in a flat table, reading through the handle is then a single load.
+	// Slots are rewritten whenever the file is loaded or reloaded, and by the matching Set call. Every
+	// lookup of a key must pass the same default.
+	ConfigInt FindInt(const char* key, int defaultValue = 0);
+	ConfigBool FindBool(const char* key, bool defaultValue = false);
+	ConfigFloat FindFloat(const char* key, float defaultValue = 0.0f);
+
+	// Watches the loaded file from Update and swaps in its new contents when it changes. Strings from
+	// GetString stay valid until the Update after a reload, don't keep them across frames.
+	void SetHotReload(bool enable);
+	void Update();
+
 private:
 	class Impl;
 	std::unique_ptr<Impl> mImpl;
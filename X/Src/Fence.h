@@ -0,0 +1,64 @@
+//====================================================================================================
+// Filename:	Fence.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_FENCE_H
+#define INCLUDED_XENGINE_FENCE_H
+
+namespace X {
+
+// Counter that one thread raises as it finishes work and other threads wait on, e.g. "frame 12 has
+// been rendered". Values only grow and wrap after 2^32 signals, comparisons are done modulo that.
+// Waiting spins briefly and then sleeps in the OS on the counter itself, there is no mutex.
+class Fence
+{
+public:
+	void Signal(uint32_t value)
+	{
+		mValue.store(value);
+		if (mWaiters.load() > 0)
+		{
+			Platform::WakeAllValue(mValue);
+		}
+	}
+
+	bool IsComplete(uint32_t value) const
+	{
+		return static_cast<int32_t>(mValue.load(std::memory_order_acquire) - value) >= 0;
+	}
+
+	void Wait(uint32_t value)
+	{
+		for (int spin = 0; spin < 64; ++spin)
+		{
+			if (IsComplete(value))
+			{
+				return;
+			}
+		}
+
+		// Registering first means a Signal that lands after the check below always wakes us
+		mWaiters.fetch_add(1);
+		for (;;)
+		{
+			const uint32_t current = mValue.load();
+			if (static_cast<int32_t>(current - value) >= 0)
+			{
+				break;
+			}
+			Platform::WaitOnValue(mValue, current);
+		}
+		mWaiters.fetch_sub(1);
+	}
+
+	uint32_t GetValue() const	{ return mValue.load(std::memory_order_acquire); }
+
+private:
+	std::atomic<uint32_t> mValue{ 0 };
+	std::atomic<uint32_t> mWaiters{ 0 };
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_FENCE_H
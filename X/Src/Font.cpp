@@ -6,16 +6,52 @@
 #include "Precompiled.h"
 #include "Font.h"
 
-#include "GraphicsSystem.h"
-#include <FW1FontWrapper/Inc/FW1FontWrapper.h>
+#include <ImGui/Inc/imgui.h>
+
+// ImGui compiles its own copy of stb_truetype with internal linkage, this one is private to the font
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <ImGui/Src/imstb_truetype.h>
 
 using namespace X;
 
+namespace
+{
+	constexpr int kGlyphCount = Font::kLastChar - Font::kFirstChar + 1;
+
+	bool ReadFontFile(const char* fileName, std::vector<uint8_t>& data)
+	{
+		FILE* file = Platform::OpenFile(fileName, "rb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		uint8_t buffer[65536];
+		size_t read = 0;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			data.insert(data.end(), buffer, buffer + read);
+		}
+		fclose(file);
+		return !data.empty();
+	}
+
+	// ImGui keeps its default font compressed, adding it to an atlas without building hands back the TTF
+	void GetDefaultFontData(std::vector<uint8_t>& data)
+	{
+		ImFontAtlas atlas;
+		atlas.AddFontDefault();
+		const ImFontConfig& config = atlas.ConfigData[0];
+		const uint8_t* fontData = static_cast<const uint8_t*>(config.FontData);
+		data.assign(fontData, fontData + config.FontDataSize);
+	}
+}
+
 //----------------------------------------------------------------------------------------------------
 
 Font::Font()
-	: mFW1Factory(nullptr)
-	, mFontWrapper(nullptr)
+	: mPixelHeight(0.0f)
+	, mAscent(0.0f)
 {
 }
 
@@ -23,30 +59,130 @@ Font::Font()
 
 Font::~Font()
 {
+	XASSERT(mGlyphs.empty(), "[Font] Font not released!");
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void Font::Initialize()
+bool Font::Initialize(const char* fileName, float pixelHeight)
 {
-	ID3D11Device* device = GraphicsSystem::Get()->GetDevice();
-	FW1CreateFactory(FW1_VERSION, &mFW1Factory);
-	auto hr = mFW1Factory->CreateFontWrapper(device, L"Consolas", &mFontWrapper);
-	XASSERT(SUCCEEDED(hr), "[Font] Failed to initialize FW1FontWrapper. Error = %x", hr);
+	XASSERT(mGlyphs.empty(), "[Font] Already initialized.");
+	XASSERT(pixelHeight > 0.0f, "[Font] Invalid pixel height %f.", pixelHeight);
+
+	std::vector<uint8_t> data;
+	if (fileName != nullptr && fileName[0] != '\0' && !ReadFontFile(fileName, data))
+	{
+		XLOG("[Font] Failed to load %s, using the built in font.", fileName);
+	}
+	if (data.empty())
+	{
+		GetDefaultFontData(data);
+	}
+
+	stbtt_fontinfo info;
+	const int offset = stbtt_GetFontOffsetForIndex(data.data(), 0);
+	if (offset < 0 || !stbtt_InitFont(&info, data.data(), offset))
+	{
+		XLOG("[Font] Font data is not TrueType.");
+		return false;
+	}
+
+	// Rows are packed top down, grow the atlas until every glyph fits
+	stbtt_bakedchar baked[kGlyphCount];
+	std::vector<uint8_t> coverage;
+	uint32_t width = 256;
+	uint32_t height = 64;
+	int usedRows = 0;
+	for (;;)
+	{
+		coverage.assign(width * height, 0);
+		usedRows = stbtt_BakeFontBitmap(data.data(), offset, pixelHeight, coverage.data(), width, height, kFirstChar, kGlyphCount, baked);
+		if (usedRows > 0)
+		{
+			break;
+		}
+		if (height < width)
+		{
+			height *= 2;
+		}
+		else
+		{
+			width *= 2;
+		}
+		if (width > 4096)
+		{
+			XLOG("[Font] Glyphs at %f pixels do not fit in a 4096 atlas.", pixelHeight);
+			return false;
+		}
+	}
+
+	// White texels with the coverage in alpha, so a tint is the text color
+	mAtlas.width = width;
+	mAtlas.height = static_cast<uint32_t>(usedRows);
+	mAtlas.pixels.resize(mAtlas.width * mAtlas.height * 4);
+	uint32_t* pixels = reinterpret_cast<uint32_t*>(mAtlas.pixels.data());
+	for (uint32_t i = 0; i < mAtlas.width * mAtlas.height; ++i)
+	{
+		pixels[i] = 0x00ffffff | (static_cast<uint32_t>(coverage[i]) << 24);
+	}
+
+	mGlyphs.resize(kGlyphCount);
+	for (int i = 0; i < kGlyphCount; ++i)
+	{
+		const stbtt_bakedchar& c = baked[i];
+		Glyph& glyph = mGlyphs[i];
+		glyph.source = { static_cast<float>(c.x0), static_cast<float>(c.y0), static_cast<float>(c.x1), static_cast<float>(c.y1) };
+		glyph.offsetX = c.xoff;
+		glyph.offsetY = c.yoff;
+		glyph.advance = c.xadvance;
+	}
+
+	int ascent = 0, descent = 0, lineGap = 0;
+	stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+	mAscent = ascent * stbtt_ScaleForPixelHeight(&info, pixelHeight);
+	mPixelHeight = pixelHeight;
+	return true;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void Font::Terminate()
 {
-	SafeRelease(mFontWrapper);
-	SafeRelease(mFW1Factory);
+	mAtlas = Image();
+	mGlyphs.clear();
+	mGlyphs.shrink_to_fit();
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void Font::Draw(const wchar_t* str, float x, float y, float size, uint32_t color)
+void Font::Layout(const wchar_t* str, float size, std::vector<GlyphQuad>& quads) const
 {
-	ID3D11DeviceContext* context = GraphicsSystem::Get()->GetContext();
-	mFontWrapper->DrawString(context, str, x, y, size, color, FW1_RESTORESTATE);
-}
\ No newline at end of file
+	XASSERT(!mGlyphs.empty(), "[Font] Not initialized.");
+	quads.clear();
+
+	const float scale = size > 0.0f ? size / mPixelHeight : 1.0f;
+	float penX = 0.0f;
+	float baseline = mAscent * scale;
+	for (const wchar_t* c = str; *c != L'\0'; ++c)
+	{
+		if (*c == L'\n')
+		{
+			penX = 0.0f;
+			baseline += mPixelHeight * scale;
+			continue;
+		}
+
+		const wchar_t ch = (*c >= kFirstChar && *c <= kLastChar) ? *c : L'?';
+		const Glyph& glyph = mGlyphs[ch - kFirstChar];
+		if (glyph.source.right > glyph.source.left && glyph.source.bottom > glyph.source.top)
+		{
+			GlyphQuad& quad = quads.emplace_back();
+			quad.source = glyph.source;
+			quad.destination.left = penX + glyph.offsetX * scale;
+			quad.destination.top = baseline + glyph.offsetY * scale;
+			quad.destination.right = quad.destination.left + (glyph.source.right - glyph.source.left) * scale;
+			quad.destination.bottom = quad.destination.top + (glyph.source.bottom - glyph.source.top) * scale;
+		}
+		penX += glyph.advance * scale;
+	}
+}
@@ -6,27 +6,59 @@
 #ifndef INCLUDED_XENGINE_FONT_H
 #define INCLUDED_XENGINE_FONT_H
 
-interface IFW1Factory;
-interface IFW1FontWrapper;
+#include "Image.h"
+#include "XMath.h"
 
 namespace X {
 
+// Where a glyph's cell in the font atlas lands, relative to the top left of the text
+struct GlyphQuad
+{
+	Math::Rect source;
+	Math::Rect destination;
+};
+
+// Bitmap font rasterized once with stb_truetype into an RGBA8 atlas, white with the coverage in alpha.
+// Text is laid out into glyph quads which the sprite backends draw tinted in one batch, so drawing
+// text does no font work and needs no font system.
 class Font
 {
 public:
+	static constexpr wchar_t kFirstChar = 32;
+	static constexpr wchar_t kLastChar = 255;
+
 	Font();
 	~Font();
 
-	void Initialize();
+	Font(const Font&) = delete;
+	Font& operator=(const Font&) = delete;
+
+	// Bakes printable Latin-1 at the given pixel height. An empty file name uses ImGui's built in
+	// ProggyClean, which is a pixel font made for 13 pixels.
+	bool Initialize(const char* fileName, float pixelHeight);
 	void Terminate();
 
-	void Draw(const wchar_t* str, float x, float y, float size, uint32_t color);
+	// Replaces quads with the layout of str, a size of 0 uses the baked pixel height. Characters
+	// outside the baked range are drawn as '?'.
+	void Layout(const wchar_t* str, float size, std::vector<GlyphQuad>& quads) const;
+
+	const Image& GetAtlas() const	{ return mAtlas; }
+	float GetPixelHeight() const	{ return mPixelHeight; }
 
 private:
-	IFW1Factory* mFW1Factory;
-	IFW1FontWrapper* mFontWrapper;
+	struct Glyph
+	{
+		Math::Rect source;
+		float offsetX, offsetY;
+		float advance;
+	};
+
+	Image mAtlas;
+	std::vector<Glyph> mGlyphs;
+	float mPixelHeight;
+	float mAscent;
 };
 
 } // namespace X
 
-#endif // #ifndef INCLUDED_XENGINE_FONT_H
\ No newline at end of file
+#endif // #ifndef INCLUDED_XENGINE_FONT_H
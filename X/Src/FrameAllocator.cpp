@@ -0,0 +1,129 @@
+//====================================================================================================
+// Filename:	FrameAllocator.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "FrameAllocator.h"
+
+using namespace X;
+
+namespace
+{
+	inline size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+FrameAllocator::FrameAllocator()
+	: mCurrent(0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+FrameAllocator::~FrameAllocator()
+{
+	XASSERT(mArenas[0].block == nullptr, "[FrameAllocator] Allocator not freed.");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void FrameAllocator::Initialize(size_t arenaSize)
+{
+	XASSERT(mArenas[0].block == nullptr, "[FrameAllocator] Already initialized.");
+	XASSERT(arenaSize > 0, "[FrameAllocator] Arena size must not be 0.");
+	for (Arena& arena : mArenas)
+	{
+		arena.block = std::make_unique<uint8_t[]>(arenaSize);
+		arena.capacity = arenaSize;
+	}
+	mCurrent = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void FrameAllocator::Terminate()
+{
+	for (Arena& arena : mArenas)
+	{
+		arena = Arena();
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void FrameAllocator::Flip()
+{
+	mCurrent ^= 1;
+	Reset(mArenas[mCurrent]);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	XASSERT((alignment & (alignment - 1)) == 0 && alignment <= alignof(std::max_align_t), "[FrameAllocator] Unsupported alignment %zu.", alignment);
+	Arena& arena = mArenas[mCurrent];
+	XASSERT(arena.block != nullptr, "[FrameAllocator] Not initialized.");
+
+	const size_t offset = AlignUp(arena.used, alignment);
+	if (offset + size <= arena.capacity)
+	{
+		arena.used = offset + size;
+		return arena.block.get() + offset;
+	}
+
+	// Out of space, carry on in overflow blocks of at least the arena size until the next reset
+	if (arena.overflow.empty() || AlignUp(arena.overflowUsed, alignment) + size > arena.overflowCapacity)
+	{
+		arena.overflowCapacity = std::max(arena.capacity, size);
+		arena.overflow.push_back(std::make_unique<uint8_t[]>(arena.overflowCapacity));
+		arena.overflowRetired += arena.overflowUsed;
+		arena.overflowUsed = 0;
+	}
+	const size_t overflowOffset = AlignUp(arena.overflowUsed, alignment);
+	arena.overflowUsed = overflowOffset + size;
+	return arena.overflow.back().get() + overflowOffset;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+size_t FrameAllocator::GetUsed() const
+{
+	const Arena& arena = mArenas[mCurrent];
+	return arena.used + arena.overflowRetired + arena.overflowUsed;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+size_t FrameAllocator::GetCapacity() const
+{
+	return mArenas[0].capacity + mArenas[1].capacity;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void FrameAllocator::Reset(Arena& arena)
+{
+	if (!arena.overflow.empty())
+	{
+		// Grow to a single block that would have held the whole frame
+		const size_t required = arena.used + arena.overflowRetired + arena.overflowUsed;
+		size_t capacity = arena.capacity;
+		while (capacity < required)
+		{
+			capacity *= 2;
+		}
+		arena.overflow.clear();
+		arena.block = std::make_unique<uint8_t[]>(capacity);
+		arena.capacity = capacity;
+		arena.overflowCapacity = 0;
+		arena.overflowUsed = 0;
+		arena.overflowRetired = 0;
+	}
+	arena.used = 0;
+}
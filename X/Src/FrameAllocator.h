@@ -0,0 +1,144 @@
+//====================================================================================================
+// Filename:	FrameAllocator.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_FRAMEALLOCATOR_H
+#define INCLUDED_XENGINE_FRAMEALLOCATOR_H
+
+namespace X {
+
+// Two linear arenas used on alternate frames. Allocating is a pointer bump and nothing is freed
+// individually; Flip empties the arena of two frames ago and makes it current, so memory handed out
+// during a frame stays valid through the next one. An arena that overflowed is rebuilt as one block
+// big enough for that frame, after which the same workload does not touch the heap.
+class FrameAllocator
+{
+public:
+	FrameAllocator();
+	~FrameAllocator();
+
+	FrameAllocator(const FrameAllocator&) = delete;
+	FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+	void Initialize(size_t arenaSize);
+	void Terminate();
+
+	void Flip();
+
+	// Alignment must be a power of two no larger than alignof(std::max_align_t)
+	void* Allocate(size_t size, size_t alignment);
+
+	template <class T>
+	T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Frame memory is never destructed.");
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// Bytes handed out from the current arena and the size of both arenas together
+	size_t GetUsed() const;
+	size_t GetCapacity() const;
+
+private:
+	struct Arena
+	{
+		std::unique_ptr<uint8_t[]> block;
+		size_t capacity = 0;
+		size_t used = 0;
+
+		// Blocks added when the main one filled up, released on the next reset. Retired counts the
+		// bytes used in overflow blocks that are full.
+		std::vector<std::unique_ptr<uint8_t[]>> overflow;
+		size_t overflowCapacity = 0;
+		size_t overflowUsed = 0;
+		size_t overflowRetired = 0;
+	};
+
+	void Reset(Arena& arena);
+
+	Arena mArenas[2];
+	uint32_t mCurrent;
+};
+
+// Append only array in frame memory for trivially copyable commands. Growing copies into a new
+// allocation of twice the size and abandons the old one until its arena is reset. Contents belong
+// to the frame they were recorded in; clear before reusing the vector in a later frame.
+template <class T>
+class FrameVector
+{
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Frame commands must be plain data.");
+
+public:
+	explicit FrameVector(FrameAllocator& allocator)
+		: mAllocator(allocator)
+	{}
+
+	template <class... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (mSize == mCapacity)
+		{
+			Grow(mSize + 1);
+		}
+		return *new (mData + mSize++) T{ std::forward<Args>(args)... };
+	}
+
+	void push_back(const T& value)						{ emplace_back(value); }
+
+	// Appends count uninitialized elements and returns the first
+	T* append(size_t count)
+	{
+		if (mSize + count > mCapacity)
+		{
+			Grow(mSize + count);
+		}
+		T* first = mData + mSize;
+		mSize += static_cast<uint32_t>(count);
+		return first;
+	}
+
+	void clear()
+	{
+		mData = nullptr;
+		mSize = 0;
+		mCapacity = 0;
+	}
+
+	T* data()											{ return mData; }
+	const T* data() const								{ return mData; }
+	size_t size() const									{ return mSize; }
+	bool empty() const									{ return mSize == 0; }
+	T& operator[](size_t index)							{ return mData[index]; }
+	const T& operator[](size_t index) const				{ return mData[index]; }
+	T* begin()											{ return mData; }
+	T* end()											{ return mData + mSize; }
+	const T* begin() const								{ return mData; }
+	const T* end() const								{ return mData + mSize; }
+
+private:
+	void Grow(size_t required)
+	{
+		size_t capacity = mCapacity > 0 ? mCapacity * 2 : 64;
+		while (capacity < required)
+		{
+			capacity *= 2;
+		}
+		T* data = mAllocator.Allocate<T>(capacity);
+		if (mSize > 0)
+		{
+			memcpy(data, mData, mSize * sizeof(T));
+		}
+		mData = data;
+		mCapacity = static_cast<uint32_t>(capacity);
+	}
+
+	FrameAllocator& mAllocator;
+	T* mData = nullptr;
+	uint32_t mSize = 0;
+	uint32_t mCapacity = 0;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_FRAMEALLOCATOR_H
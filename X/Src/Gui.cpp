@@ -17,6 +17,8 @@ using namespace X;
 
 namespace
 {
+	using WindowMessageHandler = LRESULT(CALLBACK*)(HWND, UINT, WPARAM, LPARAM);
+
 	HWND sWindow;
 	WindowMessageHandler sPreviousWndProc = 0;
 
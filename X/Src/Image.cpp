@@ -0,0 +1,88 @@
+//====================================================================================================
+// Filename:	Image.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "Image.h"
+
+#if defined(_WIN32)
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+bool X::DecodeImage(const char* fileName, Image& image)
+{
+	wchar_t wbuffer[1024];
+	mbstowcs_s(nullptr, wbuffer, fileName, 1024);
+
+	IWICImagingFactory* factory = nullptr;
+	IWICBitmapDecoder* decoder = nullptr;
+	IWICBitmapFrameDecode* frame = nullptr;
+	IWICFormatConverter* converter = nullptr;
+
+	HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (SUCCEEDED(hr))
+	{
+		hr = factory->CreateDecoderFromFilename(wbuffer, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = decoder->GetFrame(0, &frame);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = factory->CreateFormatConverter(&converter);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+	}
+
+	UINT width = 0, height = 0;
+	if (SUCCEEDED(hr))
+	{
+		hr = converter->GetSize(&width, &height);
+	}
+	if (SUCCEEDED(hr))
+	{
+		const UINT stride = width * 4;
+		image.width = width;
+		image.height = height;
+		image.pixels.resize(stride * height);
+		hr = converter->CopyPixels(nullptr, stride, static_cast<UINT>(image.pixels.size()), image.pixels.data());
+	}
+
+	SafeRelease(converter);
+	SafeRelease(frame);
+	SafeRelease(decoder);
+	SafeRelease(factory);
+
+	if (FAILED(hr))
+	{
+		XLOG("[Image] Failed to decode image %s. HRESULT: 0x%x", fileName, hr);
+		image = Image();
+		return false;
+	}
+	return true;
+}
+
+#else
+
+#include "PngCodec.h"
+
+bool X::DecodeImage(const char* fileName, Image& image)
+{
+	// Only PNG is built in, there is no WIC to fall back on
+	const char* extension = strrchr(fileName, '.');
+	if (extension != nullptr && Platform::CompareNoCase(extension, ".png") == 0)
+	{
+		return LoadPng(fileName, image);
+	}
+
+	XLOG("[Image] No decoder for %s on this platform.", fileName);
+	image = Image();
+	return false;
+}
+
+#endif // #if defined(_WIN32)
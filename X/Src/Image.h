@@ -0,0 +1,24 @@
+//====================================================================================================
+// Filename:	Image.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_IMAGE_H
+#define INCLUDED_XENGINE_IMAGE_H
+
+namespace X {
+
+// CPU side pixels, always RGBA8 with rows tightly packed
+struct Image
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<uint8_t> pixels;
+};
+
+// Decodes any format supported by WIC (png, jpg, bmp, ...) into RGBA8. Elsewhere only png is supported.
+bool DecodeImage(const char* fileName, Image& image);
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_IMAGE_H
@@ -11,141 +11,16 @@ using namespace X;
 namespace
 {
 	InputSystem* sInputSystem = nullptr;
-	WindowMessageHandler sPreviousWndProc = 0;
 
-	void ClipToWindow(HWND window)
-	{
-		RECT rect;
-		GetClientRect(window, &rect);
-
-		POINT ul;
-		ul.x = rect.left;
-		ul.y = rect.top;
-
-		POINT lr;
-		lr.x = rect.right;
-		lr.y = rect.bottom;
-
-		MapWindowPoints(window, nullptr, &ul, 1);
-		MapWindowPoints(window, nullptr, &lr, 1);
-
-		rect.left = ul.x;
-		rect.top = ul.y;
-
-		rect.right = lr.x;
-		rect.bottom = lr.y;
-
-		ClipCursor(&rect);
-	}
+	// Same dead zone as DirectXTK's GamePad::State helpers
+	constexpr float kAnalogThreshold = 0.5f;
 }
 
-LRESULT CALLBACK X::InputSystemMessageHandler(HWND window, UINT message, WPARAM wParam, LPARAM lParam)
-{
-	if (sInputSystem == nullptr)
-	{
-		return sPreviousWndProc(window, message, wParam, lParam);
-	}
-
-	switch (message)
-	{
-		case WM_ACTIVATEAPP:
-		{
-			if (wParam == TRUE)
-			{
-				SetCapture(window);
-			}
-			else
-			{
-				sInputSystem->mMouseLeftEdge = false;
-				sInputSystem->mMouseRightEdge = false;
-				sInputSystem->mMouseTopEdge = false;
-				sInputSystem->mMouseBottomEdge = false;
-				ReleaseCapture();
-			}
-			break;
-		}
-		case WM_LBUTTONDOWN:
-		{
-			sInputSystem->mCurrMouseButtons[0] = true;
-			break;
-		}
-		case WM_LBUTTONUP:
-		{
-			sInputSystem->mCurrMouseButtons[0] = false;
-			break;
-		}
-		case WM_RBUTTONDOWN:
-		{
-			sInputSystem->mCurrMouseButtons[1] = true;
-			break;
-		}
-		case WM_RBUTTONUP:
-		{
-			sInputSystem->mCurrMouseButtons[1] = false;
-			break;
-		}
-		case WM_MBUTTONDOWN:
-		{
-			sInputSystem->mCurrMouseButtons[2] = true;
-			break;
-		}
-		case WM_MBUTTONUP:
-		{
-			sInputSystem->mCurrMouseButtons[2] = false;
-			break;
-		}
-		case WM_MOUSEWHEEL:
-		{
-			sInputSystem->mMouseWheel += (float)GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA;
-			break;
-		}
-		case WM_MOUSEMOVE:
-		{
-			int mouseX = (signed short)(lParam);
-			int mouseY = (signed short)(lParam >> 16);
-
-			sInputSystem->mCurrMouseX = mouseX;
-			sInputSystem->mCurrMouseY = mouseY;
-			if (sInputSystem->mPrevMouseX == -1)
-			{
-				sInputSystem->mPrevMouseX = mouseX;
-				sInputSystem->mPrevMouseY = mouseY;
-			}
-
-			RECT rect;
-			GetClientRect(window, &rect);
-			sInputSystem->mMouseLeftEdge = mouseX <= rect.left;
-			sInputSystem->mMouseRightEdge = mouseX + 1 >= rect.right;
-			sInputSystem->mMouseTopEdge = mouseY <= rect.top;
-			sInputSystem->mMouseBottomEdge = mouseY + 1 >= rect.bottom;
-			break;
-		}
-		case WM_KEYDOWN:
-		{
-			if (wParam < 256)
-			{
-				sInputSystem->mCurrKeys[wParam] = true;
-			}
-			break;
-		}
-		case WM_KEYUP:
-		{
-			if (wParam < 256)
-			{
-				sInputSystem->mCurrKeys[wParam] = false;
-			}
-			break;
-		}
-	}
-
-	return sPreviousWndProc(window, message, wParam, lParam);
-}
-
-void InputSystem::StaticInitialize(HWND window)
+void InputSystem::StaticInitialize()
 {
 	XASSERT(sInputSystem == nullptr, "[InputSystem] System already initialized!");
 	sInputSystem = new InputSystem();
-	sInputSystem->Initialize(window);
+	sInputSystem->Initialize();
 }
 
 void InputSystem::StaticTerminate()
@@ -164,9 +39,7 @@ InputSystem* InputSystem::Get()
 }
 
 InputSystem::InputSystem()
-	: mWindow(0)
-	, mGamePad{ nullptr }
-	, mGamePadState{}
+	: mGamePadState{}
 	, mClipMouseToWindow(false)
 	, mCurrMouseX(-1)
 	, mCurrMouseY(-1)
@@ -181,12 +54,12 @@ InputSystem::InputSystem()
 	, mMouseBottomEdge(false)
 	, mInitialized(false)
 {
-	ZeroMemory(&mCurrKeys, sizeof(mCurrKeys));
-	ZeroMemory(&mPrevKeys, sizeof(mPrevKeys));
-	ZeroMemory(&mPressedKeys, sizeof(mPressedKeys));
-	ZeroMemory(&mCurrMouseButtons, sizeof(mCurrMouseButtons));
-	ZeroMemory(&mPrevMouseButtons, sizeof(mPrevMouseButtons));
-	ZeroMemory(&mPressedMouseButtons, sizeof(mPressedMouseButtons));
+	memset(&mCurrKeys, 0, sizeof(mCurrKeys));
+	memset(&mPrevKeys, 0, sizeof(mPrevKeys));
+	memset(&mPressedKeys, 0, sizeof(mPressedKeys));
+	memset(&mCurrMouseButtons, 0, sizeof(mCurrMouseButtons));
+	memset(&mPrevMouseButtons, 0, sizeof(mPrevMouseButtons));
+	memset(&mPressedMouseButtons, 0, sizeof(mPressedMouseButtons));
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -198,7 +71,7 @@ InputSystem::~InputSystem()
 
 //----------------------------------------------------------------------------------------------------
 
-void InputSystem::Initialize(HWND window)
+void InputSystem::Initialize()
 {
 	// Check if we have already initialized the system
 	if (mInitialized)
@@ -209,12 +82,8 @@ void InputSystem::Initialize(HWND window)
 
 	XLOG("[InputSystem] Initializing...");
 	
-	// Hook application to window's procedure
-	mWindow = window;
-	sPreviousWndProc = (WindowMessageHandler)GetWindowLongPtrA(window, GWLP_WNDPROC);
-	SetWindowLongPtrA(window, GWLP_WNDPROC, (LONG_PTR)InputSystemMessageHandler);
-
-	mGamePad = std::make_unique<DirectX::GamePad>();
+	// Receive the window's keyboard and mouse events
+	Platform::SetInputSystem(this);
 
 	// Set flag
 	mInitialized = true;
@@ -235,9 +104,8 @@ void InputSystem::Terminate()
 
 	XLOG("[InputSystem] Terminating...");
 
-	// Restore original window's procedure
-	SetWindowLongPtrA(mWindow, GWLP_WNDPROC, (LONG_PTR)sPreviousWndProc);
-	mWindow = nullptr;
+	// Stop receiving window events
+	Platform::SetInputSystem(nullptr);
 
 	// Set flag
 	mInitialized = false;
@@ -272,7 +140,62 @@ void InputSystem::Update()
 	memcpy(mPrevMouseButtons, mCurrMouseButtons, sizeof(mCurrMouseButtons));
 
 	for (size_t i = 0; i < std::size(mGamePadState); ++i)
-		mGamePadState[i] = mGamePad->GetState((int)i);
+		Platform::ReadGamePad((int)i, mGamePadState[i]);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void InputSystem::SetKey(uint32_t key, bool down)
+{
+	if (key < 256)
+	{
+		mCurrKeys[key] = down;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void InputSystem::SetMouseButton(uint32_t button, bool down)
+{
+	if (button < std::size(mCurrMouseButtons))
+	{
+		mCurrMouseButtons[button] = down;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void InputSystem::SetMousePosition(int x, int y, int clientWidth, int clientHeight)
+{
+	mCurrMouseX = x;
+	mCurrMouseY = y;
+	if (mPrevMouseX == -1)
+	{
+		mPrevMouseX = x;
+		mPrevMouseY = y;
+	}
+
+	mMouseLeftEdge = x <= 0;
+	mMouseRightEdge = x + 1 >= clientWidth;
+	mMouseTopEdge = y <= 0;
+	mMouseBottomEdge = y + 1 >= clientHeight;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void InputSystem::AddMouseWheel(float delta)
+{
+	mMouseWheel += delta;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void InputSystem::ClearMouseEdges()
+{
+	mMouseLeftEdge = false;
+	mMouseRightEdge = false;
+	mMouseTopEdge = false;
+	mMouseBottomEdge = false;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -370,7 +293,7 @@ bool InputSystem::IsMouseBottomEdge() const
 
 void InputSystem::ShowSystemCursor(bool show)
 {
-	ShowCursor(show);
+	Platform::ShowSystemCursor(show);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -398,166 +321,166 @@ bool InputSystem::IsGamePadConnected(int player) const
 
 bool InputSystem::IsAPressed(int player) const
 {
-	return mGamePadState[player].IsAPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::A) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsBPressed(int player) const
 {
-	return mGamePadState[player].IsBPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::B) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsXPressed(int player) const
 {
-	return mGamePadState[player].IsXPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::X) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsYPressed(int player) const
 {
-	return mGamePadState[player].IsYPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::Y) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftShoulderPressed(int player) const
 {
-	return mGamePadState[player].IsLeftShoulderPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::LeftShoulder) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftTriggerPressed(int player) const
 {
-	return mGamePadState[player].IsLeftTriggerPressed();
+	return mGamePadState[player].leftTrigger > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightShoulderPressed(int player) const
 {
-	return mGamePadState[player].IsRightShoulderPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::RightShoulder) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightTriggerPressed(int player) const
 {
-	return mGamePadState[player].IsRightTriggerPressed();
+	return mGamePadState[player].rightTrigger > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsDPadUp(int player) const
 {
-	return mGamePadState[player].IsDPadUpPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::DPadUp) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsDPadDown(int player) const
 {
-	return mGamePadState[player].IsDPadDownPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::DPadDown) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsDPadLeft(int player) const
 {
-	return mGamePadState[player].IsDPadLeftPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::DPadLeft) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsDPadRight(int player) const
 {
-	return mGamePadState[player].IsDPadRightPressed();
+	return (mGamePadState[player].buttons & Platform::GamePadState::DPadRight) != 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftThumbStickUp(int player) const
 {
-	return mGamePadState[player].IsLeftThumbStickUp();
+	return mGamePadState[player].leftY > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftThumbStickDown(int player) const
 {
-	return mGamePadState[player].IsLeftThumbStickDown();
+	return mGamePadState[player].leftY < -kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftThumbStickLeft(int player) const
 {
-	return mGamePadState[player].IsLeftThumbStickLeft();
+	return mGamePadState[player].leftX < -kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsLeftThumbStickRight(int player) const
 {
-	return mGamePadState[player].IsLeftThumbStickRight();
+	return mGamePadState[player].leftX > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightThumbStickUp(int player) const
 {
-	return mGamePadState[player].IsRightThumbStickUp();
+	return mGamePadState[player].rightY > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightThumbStickDown(int player) const
 {
-	return mGamePadState[player].IsRightThumbStickDown();
+	return mGamePadState[player].rightY < -kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightThumbStickLeft(int player) const
 {
-	return mGamePadState[player].IsRightThumbStickLeft();
+	return mGamePadState[player].rightX < -kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool InputSystem::IsRightThumbStickRight(int player) const
 {
-	return mGamePadState[player].IsRightThumbStickRight();
+	return mGamePadState[player].rightX > kAnalogThreshold;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float InputSystem::GetLeftAnalogX(int player) const
 {
-	return mGamePadState[player].thumbSticks.leftX;
+	return mGamePadState[player].leftX;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float InputSystem::GetLeftAnalogY(int player) const
 {
-	return mGamePadState[player].thumbSticks.leftY;
+	return mGamePadState[player].leftY;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float InputSystem::GetRightAnalogX(int player) const
 {
-	return mGamePadState[player].thumbSticks.rightX;
+	return mGamePadState[player].rightX;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float InputSystem::GetRightAnalogY(int player) const
 {
-	return mGamePadState[player].thumbSticks.rightY;
+	return mGamePadState[player].rightY;
 }
\ No newline at end of file
@@ -6,15 +6,15 @@
 #ifndef INCLUDED_XENGINE_INPUTSYSTEM_H
 #define INCLUDED_XENGINE_INPUTSYSTEM_H
 
+#include "Platform.h"
 #include "XTypes.h"
-#include <DirectXTK/Inc/GamePad.h>
 
 namespace X {
 
 class InputSystem
 {
 public:
-	static void StaticInitialize(HWND window);
+	static void StaticInitialize();
 	static void StaticTerminate();
 	static InputSystem* Get();
 
@@ -25,11 +25,19 @@ public:
 	InputSystem(const InputSystem&) = delete;
 	InputSystem& operator=(const InputSystem&) = delete;
 
-	void Initialize(HWND window);
+	void Initialize();
 	void Terminate();
 
 	void Update();
 
+	// Input events, fed by the platform window or injected directly when running headless. They take
+	// effect on the next Update().
+	void SetKey(uint32_t key, bool down);
+	void SetMouseButton(uint32_t button, bool down);
+	void SetMousePosition(int x, int y, int clientWidth, int clientHeight);
+	void AddMouseWheel(float delta);
+	void ClearMouseEdges();
+
 	bool IsKeyDown(uint32_t key) const;
 	bool IsKeyPressed(uint32_t key) const;
 
@@ -85,12 +93,7 @@ public:
 	float GetRightAnalogY(int player) const;
 
 private:
-	friend LRESULT CALLBACK InputSystemMessageHandler(HWND window, UINT message, WPARAM wParam, LPARAM lParam);
-
-	HWND mWindow;
-
-	std::unique_ptr<DirectX::GamePad> mGamePad;
-	DirectX::GamePad::State mGamePadState[4];
+	Platform::GamePadState mGamePadState[4];
 
 	bool mCurrKeys[512];
 	bool mPrevKeys[512];
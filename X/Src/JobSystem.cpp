@@ -0,0 +1,530 @@
+//====================================================================================================
+// Filename:	JobSystem.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "JobSystem.h"
+
+using namespace X;
+
+namespace
+{
+	JobSystem* sJobSystem = nullptr;
+
+	// Tells a thread's context apart from one it registered with an earlier Initialize
+	std::atomic<uint32_t> sGeneration{ 0 };
+
+	// Idle threads try this many times to find a job before going to sleep
+	constexpr int kIdleSpins = 64;
+
+	// Numbers each job run on this thread, 0 outside of jobs. A nested job gets its own number and the
+	// outer one's is back once it returns.
+	thread_local uint32_t sCurrentJob = 0;
+	thread_local uint32_t sJobsStarted = 0;
+
+	class JobScope
+	{
+	public:
+		JobScope()
+			: mOuter(sCurrentJob)
+		{
+			// Skip 0 when the count wraps
+			sCurrentJob = ++sJobsStarted;
+			if (sCurrentJob == 0)
+			{
+				sCurrentJob = ++sJobsStarted;
+			}
+		}
+
+		~JobScope()
+		{
+			sCurrentJob = mOuter;
+		}
+
+	private:
+		uint32_t mOuter;
+	};
+}
+
+void JobSystem::StaticInitialize(uint32_t workerCount)
+{
+	XASSERT(sJobSystem == nullptr, "[JobSystem] System already initialized!");
+	sJobSystem = new JobSystem();
+	sJobSystem->Initialize(workerCount);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::StaticTerminate()
+{
+	if (sJobSystem != nullptr)
+	{
+		sJobSystem->Terminate();
+		SafeDelete(sJobSystem);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+JobSystem* JobSystem::Get()
+{
+	XASSERT(sJobSystem != nullptr, "[JobSystem] No instance registered.");
+	return sJobSystem;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t JobSystem::GetCurrentJob()
+{
+	return sCurrentJob;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+JobSystem::JobSystem()
+	: mContexts{}
+	, mContextCount(0)
+	, mGeneration(0)
+	, mWorkSignal(0)
+	, mSleepers(0)
+	, mRunning(false)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+JobSystem::~JobSystem()
+{
+	XASSERT(mContextCount.load() == 0, "[JobSystem] Terminate() must be called to clean up!");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Initialize(uint32_t workerCount)
+{
+	XASSERT(!mRunning, "[JobSystem] System already initialized.");
+	XASSERT(workerCount < kMaxThreads, "[JobSystem] At most %u workers.", kMaxThreads - 1);
+	mGeneration = ++sGeneration;
+	mRunning = true;
+	workerCount = std::min(workerCount, kMaxThreads - 1);
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		mWorkers.emplace_back(&JobSystem::Worker, this);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Terminate()
+{
+	// Jobs still queued are dropped, whoever scheduled them should have waited
+	mRunning = false;
+	mWorkSignal.fetch_add(1);
+	Platform::WakeAllValue(mWorkSignal);
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+
+	const uint32_t contextCount = mContextCount.exchange(0);
+	for (uint32_t i = 0; i < contextCount; ++i)
+	{
+		SafeDelete(mContexts[i]);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Run(JobFunction function, void* data, JobCounter& counter)
+{
+	ThreadContext* context = GetContext();
+	AddPending(counter);
+	if (context == nullptr)
+	{
+		{
+			JobScope scope;
+			function(data);
+		}
+		Finish(nullptr, counter);
+		return;
+	}
+
+	Job* job = AllocateJob(*context);
+	job->function = function;
+	job->data = data;
+	job->counter = &counter;
+	Push(context, job);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::RunAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter& counter)
+{
+	ThreadContext* context = GetContext();
+	AddPending(counter);
+	if (context == nullptr)
+	{
+		Wait(dependency);
+		{
+			JobScope scope;
+			function(data);
+		}
+		Finish(nullptr, counter);
+		return;
+	}
+
+	Job* job = AllocateJob(*context);
+	job->function = function;
+	job->data = data;
+	job->counter = &counter;
+
+	// Whichever side takes the waiting list after the count reaches 0 schedules it, so a dependency
+	// finishing while the job is being added cannot strand it
+	job->next = dependency.mWaiting.load();
+	while (!dependency.mWaiting.compare_exchange_weak(job->next, job))
+	{
+	}
+	if (static_cast<uint32_t>(dependency.mState.load()) == 0)
+	{
+		for (Job* waiting = dependency.mWaiting.exchange(nullptr); waiting != nullptr;)
+		{
+			Job* next = waiting->next;
+			Push(context, waiting);
+			waiting = next;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, JobRangeFunction function, void* data)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	ThreadContext* context = GetContext();
+	if (context == nullptr)
+	{
+		JobScope scope;
+		function(data, 0, count);
+		return;
+	}
+
+	// The first job splits itself in halves as it runs, the caller starts on it straight away
+	JobCounter counter;
+	AddPending(counter);
+	Job* job = AllocateJob(*context);
+	job->rangeFunction = function;
+	job->data = data;
+	job->begin = 0;
+	job->end = count;
+	job->grainSize = std::max(grainSize, 1u);
+	job->counter = &counter;
+	Execute(context, job);
+	Wait(counter);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	ThreadContext* context = GetContext();
+	while (!counter.IsDone())
+	{
+		Job* job = context ? FindJob(*context) : nullptr;
+		if (job)
+		{
+			Execute(context, job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool JobSystem::Deque::Push(Job* job)
+{
+	const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+	const int64_t top = mTop.load(std::memory_order_acquire);
+	if (bottom - top >= static_cast<int64_t>(kDequeCapacity))
+	{
+		return false;
+	}
+	mJobs[bottom & (kDequeCapacity - 1)].store(job, std::memory_order_relaxed);
+	mBottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Job* JobSystem::Deque::Pop()
+{
+	const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+	mBottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = mTop.load(std::memory_order_relaxed);
+	if (top > bottom)
+	{
+		// Empty
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = mJobs[bottom & (kDequeCapacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Job* JobSystem::Deque::Steal()
+{
+	int64_t top = mTop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = mBottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* job = mJobs[top & (kDequeCapacity - 1)].load(std::memory_order_relaxed);
+	if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		// Lost to the owner or another thief
+		return nullptr;
+	}
+	return job;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+JobSystem::ThreadContext* JobSystem::GetContext()
+{
+	thread_local ThreadContext* context = nullptr;
+	thread_local uint32_t generation = 0;
+	if (generation != mGeneration)
+	{
+		std::lock_guard<std::mutex> lock(mContextMutex);
+		const uint32_t index = mContextCount.load();
+		if (index == kMaxThreads)
+		{
+			XLOG("[JobSystem] More than %u threads using jobs, running them inline.", kMaxThreads);
+			return nullptr;
+		}
+		context = new ThreadContext();
+		context->jobs = std::make_unique<Job[]>(kJobsPerThread);
+		context->victim = index;
+		mContexts[index] = context;
+		mContextCount.store(index + 1, std::memory_order_release);
+		generation = mGeneration;
+	}
+	return context;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Job* JobSystem::AllocateJob(ThreadContext& context)
+{
+	// Jobs are reused round robin, skipping slots still queued or waiting on a dependency. Only a
+	// thread with every slot in flight helps out until one comes free.
+	for (;;)
+	{
+		for (uint32_t i = 0; i < kJobsPerThread; ++i)
+		{
+			Job* job = &context.jobs[context.nextJob++ & (kJobsPerThread - 1)];
+			if (!job->inUse.load(std::memory_order_acquire))
+			{
+				job->function = nullptr;
+				job->rangeFunction = nullptr;
+				job->next = nullptr;
+				job->inUse.store(true, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		if (Job* other = FindJob(context))
+		{
+			Execute(&context, other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Push(ThreadContext* context, Job* job)
+{
+	if (context == nullptr || !context->deque.Push(job))
+	{
+		Execute(context, job);
+		return;
+	}
+
+	// Pairs with the sleeper count in Worker, either the worker sees the new signal or we see it asleep.
+	// One job needs one worker, the rest stay asleep.
+	mWorkSignal.fetch_add(1);
+	if (mSleepers.load() > 0)
+	{
+		Platform::WakeValue(mWorkSignal);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Job* JobSystem::FindJob(ThreadContext& context)
+{
+	if (Job* job = context.deque.Pop())
+	{
+		return job;
+	}
+
+	// Steal round robin, starting after whoever was robbed last
+	const uint32_t contextCount = mContextCount.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < contextCount; ++i)
+	{
+		const uint32_t victim = (context.victim + i) % contextCount;
+		ThreadContext* other = mContexts[victim];
+		if (other == &context)
+		{
+			continue;
+		}
+		if (Job* job = other->deque.Steal())
+		{
+			context.victim = victim;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Execute(ThreadContext* context, Job* job)
+{
+	// Copy out and free the slot first, the job may schedule enough to need it again
+	const JobFunction function = job->function;
+	const JobRangeFunction rangeFunction = job->rangeFunction;
+	void* data = job->data;
+	uint32_t begin = job->begin;
+	uint32_t end = job->end;
+	const uint32_t grainSize = job->grainSize;
+	JobCounter& counter = *job->counter;
+	job->inUse.store(false, std::memory_order_release);
+
+	if (function)
+	{
+		JobScope scope;
+		function(data);
+	}
+	else
+	{
+		// Hand the upper half to thieves until what is left is one grain
+		while (context && end - begin > grainSize)
+		{
+			const uint32_t middle = begin + (end - begin) / 2;
+			Job* half = AllocateJob(*context);
+			half->rangeFunction = rangeFunction;
+			half->data = data;
+			half->begin = middle;
+			half->end = end;
+			half->grainSize = grainSize;
+			half->counter = &counter;
+			AddPending(counter);
+			Push(context, half);
+			end = middle;
+		}
+		JobScope scope;
+		rangeFunction(data, begin, end);
+	}
+	Finish(context, counter);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::AddPending(JobCounter& counter)
+{
+	counter.mState.fetch_add(1);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Finish(ThreadContext* context, JobCounter& counter)
+{
+	// Trade the pending job for a finisher in one step, the counter can't read as done while this job
+	// still touches it, even if another job is added in between
+	constexpr uint64_t kFinisher = 1ull << 32;
+	const uint64_t state = counter.mState.fetch_add(kFinisher - 1);
+	Job* waiting = nullptr;
+	if (static_cast<uint32_t>(state) == 1)
+	{
+		waiting = counter.mWaiting.exchange(nullptr);
+	}
+
+	// Last touch of the counter, a waiter may destroy it right after
+	counter.mState.fetch_sub(kFinisher);
+	while (waiting != nullptr)
+	{
+		Job* next = waiting->next;
+		Push(context, waiting);
+		waiting = next;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void JobSystem::Worker()
+{
+	ThreadContext* context = GetContext();
+	if (context == nullptr)
+	{
+		return;
+	}
+
+	int idle = 0;
+	while (mRunning.load(std::memory_order_relaxed))
+	{
+		if (Job* job = FindJob(*context))
+		{
+			Execute(context, job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < kIdleSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Look once more after registering as a sleeper, a push from here on changes the signal
+		mSleepers.fetch_add(1);
+		const uint32_t signal = mWorkSignal.load();
+		Job* job = FindJob(*context);
+		if (job == nullptr && mRunning.load())
+		{
+			Platform::WaitOnValue(mWorkSignal, signal);
+		}
+		mSleepers.fetch_sub(1);
+		if (job)
+		{
+			Execute(context, job);
+		}
+		idle = 0;
+	}
+}
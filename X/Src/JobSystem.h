@@ -0,0 +1,116 @@
+//====================================================================================================
+// Filename:	JobSystem.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_JOBSYSTEM_H
+#define INCLUDED_XENGINE_JOBSYSTEM_H
+
+#include "XTypes.h"
+
+namespace X {
+
+// One scheduled function. Jobs live in a ring owned by the thread that scheduled them and are handed
+// between threads by pointer.
+struct Job
+{
+	JobFunction function = nullptr;
+	JobRangeFunction rangeFunction = nullptr;
+	void* data = nullptr;
+	uint32_t begin = 0;
+	uint32_t end = 0;
+	uint32_t grainSize = 0;
+	JobCounter* counter = nullptr;
+	Job* next = nullptr;
+	std::atomic<bool> inUse{ false };
+};
+
+// Fixed set of worker threads for short CPU jobs, unlike ThreadPool which is for blocking file
+// decodes. Every thread that schedules or waits gets its own Chase-Lev deque the first time it does:
+// the owner pushes and pops at the bottom without locking, idle threads steal from the top. Waiting
+// on a counter runs jobs instead of blocking, so the waiting thread helps and nested waits cannot
+// deadlock. Workers with nothing to steal sleep until a job is pushed.
+class JobSystem
+{
+public:
+	static void StaticInitialize(uint32_t workerCount);
+	static void StaticTerminate();
+	static JobSystem* Get();
+
+	// Identifies the job the calling thread is running, 0 when it is not in a job. Numbers are per
+	// thread and only good for telling one job run from another on the same thread.
+	static uint32_t GetCurrentJob();
+
+public:
+	JobSystem();
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void Initialize(uint32_t workerCount);
+	void Terminate();
+
+	void Run(JobFunction function, void* data, JobCounter& counter);
+
+	// The job starts once dependency is done, right away if it already is. Jobs that dependency is
+	// counting must be scheduled before this is called.
+	void RunAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter& counter);
+
+	// Calls function on slices of [0, count) no smaller than grainSize and returns once all are done
+	void ParallelFor(uint32_t count, uint32_t grainSize, JobRangeFunction function, void* data);
+
+	void Wait(JobCounter& counter);
+
+	uint32_t GetWorkerCount() const	{ return static_cast<uint32_t>(mWorkers.size()); }
+
+private:
+	static constexpr uint32_t kMaxThreads = 64;
+	static constexpr uint32_t kJobsPerThread = 1024;
+	static constexpr uint32_t kDequeCapacity = 4096;
+
+	class Deque
+	{
+	public:
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+
+	private:
+		std::atomic<int64_t> mTop{ 0 };
+		std::atomic<int64_t> mBottom{ 0 };
+		std::atomic<Job*> mJobs[kDequeCapacity];
+	};
+
+	struct ThreadContext
+	{
+		Deque deque;
+		std::unique_ptr<Job[]> jobs;
+		uint32_t nextJob = 0;
+		uint32_t victim = 0;
+	};
+
+	ThreadContext* GetContext();
+	Job* AllocateJob(ThreadContext& context);
+	// A null context is a thread that could not register, its jobs run inline
+	void Push(ThreadContext* context, Job* job);
+	Job* FindJob(ThreadContext& context);
+	void Execute(ThreadContext* context, Job* job);
+	void AddPending(JobCounter& counter);
+	void Finish(ThreadContext* context, JobCounter& counter);
+	void Worker();
+
+	ThreadContext* mContexts[kMaxThreads];
+	std::atomic<uint32_t> mContextCount;
+	std::mutex mContextMutex;
+	uint32_t mGeneration;
+
+	std::vector<std::thread> mWorkers;
+	std::atomic<uint32_t> mWorkSignal;
+	std::atomic<uint32_t> mSleepers;
+	std::atomic<bool> mRunning;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_JOBSYSTEM_H
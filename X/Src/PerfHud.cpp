@@ -0,0 +1,160 @@
+//====================================================================================================
+// Filename:	PerfHud.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "PerfHud.h"
+
+#include "SimpleDraw.h"
+#include "Vertex.h"
+#include "XMath.h"
+#include <ImGui/Inc/imgui.h>
+
+using namespace X;
+
+namespace
+{
+	constexpr uint32_t kHistorySize = 240;
+
+	struct Counter
+	{
+		std::string name;
+		int value;
+	};
+
+	struct HudState
+	{
+		std::array<float, kHistorySize> frameMs{};
+		std::array<float, kHistorySize> sorted{};
+		uint32_t next = 0;
+		uint32_t count = 0;
+
+		FrameStats last;
+		std::vector<Counter> counters;
+
+		bool visible = false;
+	};
+
+	HudState* sHudState = nullptr;
+
+	float Percentile(float* values, uint32_t count, float percent)
+	{
+		const uint32_t index = Math::Min(count - 1, static_cast<uint32_t>(count * percent));
+		std::nth_element(values, values + index, values + count);
+		return values[index];
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::Initialize(bool visible)
+{
+	XASSERT(sHudState == nullptr, "[PerfHud] Already initialized.");
+	sHudState = new HudState();
+	sHudState->visible = visible;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::Terminate()
+{
+	SafeDelete(sHudState);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::SetVisible(bool visible)
+{
+	XASSERT(sHudState != nullptr, "[PerfHud] Not initialized.");
+	sHudState->visible = visible;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PerfHud::IsVisible()
+{
+	return sHudState != nullptr && sHudState->visible;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::SetCounter(const char* name, int value)
+{
+	XASSERT(sHudState != nullptr, "[PerfHud] Not initialized.");
+	for (auto& counter : sHudState->counters)
+	{
+		if (counter.name == name)
+		{
+			counter.value = value;
+			return;
+		}
+	}
+	sHudState->counters.push_back({ name, value });
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::AddSample(const FrameStats& stats)
+{
+	XASSERT(sHudState != nullptr, "[PerfHud] Not initialized.");
+	sHudState->frameMs[sHudState->next] = stats.frameTime;
+	sHudState->next = (sHudState->next + 1) % kHistorySize;
+	sHudState->count = Math::Min(sHudState->count + 1, kHistorySize);
+	sHudState->last = stats;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PerfHud::Render()
+{
+	if (!IsVisible() || sHudState->count == 0)
+	{
+		return;
+	}
+
+	HudState& hud = *sHudState;
+	const FrameStats& last = hud.last;
+	const uint32_t vertexCapacity = SimpleDraw::GetVertexCapacity();
+
+	// Percentiles are taken over the whole history window, nth_element reorders so work on a copy
+	std::copy_n(hud.frameMs.begin(), hud.count, hud.sorted.begin());
+	const float p50 = Percentile(hud.sorted.data(), hud.count, 0.50f);
+	const float p95 = Percentile(hud.sorted.data(), hud.count, 0.95f);
+	const float p99 = Percentile(hud.sorted.data(), hud.count, 0.99f);
+
+	ImGui::SetNextWindowPos({ 10.0f, 10.0f }, ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.75f);
+	ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing);
+
+	char overlay[64];
+	snprintf(overlay, std::size(overlay), "%.2f ms", last.frameTime);
+	const uint32_t offset = hud.count < kHistorySize ? 0 : hud.next;
+	ImGui::PlotLines("##FrameTime", hud.frameMs.data(), hud.count, offset, overlay, 0.0f, Math::Max(33.3f, p99 * 1.25f), { 300.0f, 80.0f });
+	ImGui::Text("p50 %.2f ms  p95 %.2f ms  p99 %.2f ms", p50, p95, p99);
+	ImGui::Separator();
+
+	ImGui::Text("Simulation: %.2f ms", last.simulationTime);
+	ImGui::Text("Render:     %.2f ms", last.renderTime);
+	ImGui::Separator();
+
+	ImGui::Text("Sprite commands:  %u", last.spriteCommands);
+	ImGui::Text("Texture changes:  %u", last.textureChanges);
+	ImGui::Text("Text commands:    %u", last.textCommands);
+	ImGui::Text("Vertices 2D: %u", last.vertices2D);
+	ImGui::Text("Vertices 3D: %u", last.vertices3D);
+	ImGui::Text("Vertex pages: %u KB", static_cast<uint32_t>(vertexCapacity * sizeof(VertexPC32) / 1024));
+	ImGui::Text("Audio voices:     %u", last.audioVoices);
+	ImGui::Text("Allocations:      %u", last.allocations);
+
+	if (!hud.counters.empty())
+	{
+		ImGui::Separator();
+		for (const auto& counter : hud.counters)
+		{
+			ImGui::Text("%s: %d", counter.name.c_str(), counter.value);
+		}
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,32 @@
+//====================================================================================================
+// Filename:	PerfHud.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_PERFHUD_H
+#define INCLUDED_XENGINE_PERFHUD_H
+
+#include "XTypes.h"
+
+namespace X {
+namespace PerfHud {
+
+void Initialize(bool visible);
+void Terminate();
+
+void SetVisible(bool visible);
+bool IsVisible();
+
+// Game supplied counters shown below the engine stats (e.g. entity counts)
+void SetCounter(const char* name, int value);
+
+// Records the stats of the frame that just finished
+void AddSample(const FrameStats& stats);
+
+// Draws the overlay, must be called between Gui::BeginRender and Gui::EndRender
+void Render();
+
+} // namespace PerfHud
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_PERFHUD_H
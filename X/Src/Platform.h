@@ -0,0 +1,72 @@
+//====================================================================================================
+// Filename:	Platform.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_SRC_PLATFORM_H
+#define INCLUDED_XENGINE_SRC_PLATFORM_H
+
+// Engine side platform services on top of XPlatform.h. The POSIX implementation is headless: there is
+// no window, ProcessMessages only reports a quit request and presenting a frame does nothing.
+namespace X {
+
+class InputSystem;
+struct Image;
+
+namespace Platform {
+
+struct GamePadState
+{
+	enum Button : uint32_t
+	{
+		A				= 1 << 0,
+		B				= 1 << 1,
+		X				= 1 << 2,
+		Y				= 1 << 3,
+		LeftShoulder	= 1 << 4,
+		RightShoulder	= 1 << 5,
+		DPadUp			= 1 << 6,
+		DPadDown		= 1 << 7,
+		DPadLeft		= 1 << 8,
+		DPadRight		= 1 << 9
+	};
+
+	bool connected = false;
+	uint32_t buttons = 0;
+	float leftX = 0.0f;
+	float leftY = 0.0f;
+	float rightX = 0.0f;
+	float rightY = 0.0f;
+	float leftTrigger = 0.0f;
+	float rightTrigger = 0.0f;
+};
+
+// Process wide setup, e.g. COM on Windows
+void Initialize();
+void Terminate();
+
+// Creates the main window centered on the desktop with the given client size
+bool InitializeWindow(const char* title, uint32_t width, uint32_t height);
+void TerminateWindow();
+void* GetWindowHandle();
+
+// Pumps pending window messages, returns false once the application has been asked to quit
+bool ProcessMessages();
+void PostQuit();
+
+// Keyboard and mouse events from the window are forwarded to this system
+void SetInputSystem(InputSystem* inputSystem);
+
+// Copies an RGBA8 frame to the window client area, stretched to fit
+void PresentFrame(const Image& frame);
+
+void ShowSystemCursor(bool show);
+bool ReadGamePad(int player, GamePadState& state);
+
+bool OpenFileDialog(char fileName[kMaxPath], const char* title, const char* filter);
+bool SaveFileDialog(char fileName[kMaxPath], const char* title, const char* filter);
+
+} // namespace Platform
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_SRC_PLATFORM_H
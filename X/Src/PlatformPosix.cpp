@@ -0,0 +1,243 @@
+//====================================================================================================
+// Filename:	PlatformPosix.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+
+#if !defined(_WIN32)
+
+#include "Platform.h"
+
+#include <signal.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace X;
+
+namespace
+{
+	bool sQuit = false;
+
+#if !defined(__linux__)
+	// Without an address wait, waiters sleep on a condition variable picked by address. Unrelated
+	// values can share a bucket, so wakes go to the whole bucket and the callers re-check.
+	struct WaitBucket
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	constexpr size_t kWaitBuckets = 64;
+	WaitBucket sWaitBuckets[kWaitBuckets];
+
+	WaitBucket& GetWaitBucket(const void* address)
+	{
+		return sWaitBuckets[(reinterpret_cast<uintptr_t>(address) / sizeof(uint32_t)) % kWaitBuckets];
+	}
+
+	void WakeBucket(const std::atomic<uint32_t>& value)
+	{
+		// Taking the lock orders the wake after a waiter's check of the value
+		WaitBucket& bucket = GetWaitBucket(&value);
+		{
+			std::lock_guard<std::mutex> lock(bucket.mutex);
+		}
+		bucket.condition.notify_all();
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::DebugOutput(const char* message)
+{
+	fputs(message, stderr);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::BreakIntoDebugger()
+{
+	raise(SIGTRAP);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t Platform::GetClockTicks()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t Platform::GetClockFrequency()
+{
+	return 1000000000ull;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+FILE* Platform::OpenFile(const char* fileName, const char* mode)
+{
+	return fopen(fileName, mode);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::GetFileStamp(const char* fileName, uint64_t& fileSize, uint64_t& fileTime)
+{
+	struct stat info;
+	if (stat(fileName, &info) != 0)
+	{
+		return false;
+	}
+	fileSize = static_cast<uint64_t>(info.st_size);
+	fileTime = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64_t>(info.st_mtim.tv_nsec);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int Platform::CompareNoCase(const char* a, const char* b)
+{
+	return strcasecmp(a, b);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WaitOnValue(const std::atomic<uint32_t>& value, uint32_t expected)
+{
+#if defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+	WaitBucket& bucket = GetWaitBucket(&value);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	if (value.load(std::memory_order_acquire) == expected)
+	{
+		bucket.condition.wait(lock);
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WakeValue(const std::atomic<uint32_t>& value)
+{
+#if defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&value), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+	WakeBucket(value);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WakeAllValue(const std::atomic<uint32_t>& value)
+{
+#if defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&value), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+	WakeBucket(value);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::Initialize()
+{
+	sQuit = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::Terminate()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::InitializeWindow(const char* title, uint32_t width, uint32_t height)
+{
+	XLOG("[Platform] Running headless, no window for %s (%ux%u).", title, width, height);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::TerminateWindow()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void* Platform::GetWindowHandle()
+{
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::ProcessMessages()
+{
+	return !sQuit;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::PostQuit()
+{
+	sQuit = true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::SetInputSystem(InputSystem* inputSystem)
+{
+	// No window events, input can still be injected through InputSystem directly
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::PresentFrame(const Image& frame)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::ShowSystemCursor(bool show)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::ReadGamePad(int player, GamePadState& state)
+{
+	state = GamePadState();
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::OpenFileDialog(char fileName[kMaxPath], const char* title, const char* filter)
+{
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::SaveFileDialog(char fileName[kMaxPath], const char* title, const char* filter)
+{
+	return false;
+}
+
+#endif // #if !defined(_WIN32)
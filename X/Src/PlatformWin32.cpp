@@ -0,0 +1,435 @@
+//====================================================================================================
+// Filename:	PlatformWin32.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+
+#if defined(_WIN32)
+
+#include "Platform.h"
+
+#include "Image.h"
+#include "InputSystem.h"
+#include <DirectXTK/Inc/GamePad.h>
+#include <commdlg.h>
+#include <timeapi.h>
+
+#pragma comment(lib, "Synchronization.lib")
+#pragma comment(lib, "winmm.lib")
+
+using namespace X;
+
+namespace
+{
+	const char* const kWindowClassName = "XEngineWindow";
+
+	HWND sWindow = nullptr;
+	InputSystem* sInputSystem = nullptr;
+	std::unique_ptr<DirectX::GamePad> sGamePad;
+	std::vector<uint32_t> sPresentPixels;
+
+	void GetClientSize(HWND window, int& width, int& height)
+	{
+		RECT rect;
+		GetClientRect(window, &rect);
+		width = rect.right - rect.left;
+		height = rect.bottom - rect.top;
+	}
+
+	// Translates keyboard and mouse messages into InputSystem events
+	void ForwardInput(HWND window, UINT message, WPARAM wParam, LPARAM lParam)
+	{
+		if (sInputSystem == nullptr)
+		{
+			return;
+		}
+
+		switch (message)
+		{
+		case WM_ACTIVATEAPP:
+			if (wParam == TRUE)
+			{
+				SetCapture(window);
+			}
+			else
+			{
+				sInputSystem->ClearMouseEdges();
+				ReleaseCapture();
+			}
+			break;
+		case WM_LBUTTONDOWN:	sInputSystem->SetMouseButton(Mouse::LBUTTON, true);		break;
+		case WM_LBUTTONUP:		sInputSystem->SetMouseButton(Mouse::LBUTTON, false);	break;
+		case WM_RBUTTONDOWN:	sInputSystem->SetMouseButton(Mouse::RBUTTON, true);		break;
+		case WM_RBUTTONUP:		sInputSystem->SetMouseButton(Mouse::RBUTTON, false);	break;
+		case WM_MBUTTONDOWN:	sInputSystem->SetMouseButton(Mouse::MBUTTON, true);		break;
+		case WM_MBUTTONUP:		sInputSystem->SetMouseButton(Mouse::MBUTTON, false);	break;
+		case WM_MOUSEWHEEL:
+			sInputSystem->AddMouseWheel((float)GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA);
+			break;
+		case WM_MOUSEMOVE:
+		{
+			int width = 0, height = 0;
+			GetClientSize(window, width, height);
+			sInputSystem->SetMousePosition((signed short)(lParam), (signed short)(lParam >> 16), width, height);
+			break;
+		}
+		case WM_KEYDOWN:
+			sInputSystem->SetKey(static_cast<uint32_t>(wParam), true);
+			break;
+		case WM_KEYUP:
+			sInputSystem->SetKey(static_cast<uint32_t>(wParam), false);
+			break;
+		}
+	}
+
+	LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
+	{
+		ForwardInput(hWnd, msg, wParam, lParam);
+
+		switch (msg)
+		{
+		case WM_SIZE:
+			// TODO: Resize logic
+			return 0;
+		case WM_SYSCOMMAND:
+			if ((wParam & 0xfff0) == SC_KEYMENU) // Disable ALT application menu
+				return 0;
+			break;
+		case WM_DESTROY:
+			PostQuitMessage(0);
+			return 0;
+		}
+
+		return DefWindowProcA(hWnd, msg, wParam, lParam);
+	}
+
+	bool RunFileDialog(char fileName[Platform::kMaxPath], const char* title, const char* filter, bool save)
+	{
+		OPENFILENAMEA ofn = {};
+		ofn.lStructSize = sizeof(ofn);
+		ofn.hwndOwner = sWindow;
+		ofn.lpstrFilter = filter;
+		ofn.lpstrFile = fileName;
+		ofn.nMaxFile = Platform::kMaxPath;
+		ofn.lpstrTitle = title;
+		return (save ? GetSaveFileNameA(&ofn) : GetOpenFileNameA(&ofn)) != FALSE;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::DebugOutput(const char* message)
+{
+	OutputDebugStringA(message);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::BreakIntoDebugger()
+{
+	DebugBreak();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t Platform::GetClockTicks()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return static_cast<uint64_t>(ticks.QuadPart);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t Platform::GetClockFrequency()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return static_cast<uint64_t>(frequency.QuadPart);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+FILE* Platform::OpenFile(const char* fileName, const char* mode)
+{
+	FILE* file = nullptr;
+	fopen_s(&file, fileName, mode);
+	return file;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::GetFileStamp(const char* fileName, uint64_t& fileSize, uint64_t& fileTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(fileName, GetFileExInfoStandard, &data))
+	{
+		return false;
+	}
+	fileSize = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	fileTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int Platform::CompareNoCase(const char* a, const char* b)
+{
+	return _stricmp(a, b);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WaitOnValue(const std::atomic<uint32_t>& value, uint32_t expected)
+{
+	WaitOnAddress(const_cast<std::atomic<uint32_t>*>(&value), &expected, sizeof(expected), INFINITE);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WakeValue(const std::atomic<uint32_t>& value)
+{
+	WakeByAddressSingle(const_cast<std::atomic<uint32_t>*>(&value));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::WakeAllValue(const std::atomic<uint32_t>& value)
+{
+	WakeByAddressAll(const_cast<std::atomic<uint32_t>*>(&value));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::Initialize()
+{
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	sGamePad = std::make_unique<DirectX::GamePad>();
+
+	// The default 15.6 ms scheduler tick is far too coarse for the frame limiter to sleep on
+	timeBeginPeriod(1);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::Terminate()
+{
+	timeEndPeriod(1);
+	sGamePad.reset();
+	CoUninitialize();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::InitializeWindow(const char* title, uint32_t width, uint32_t height)
+{
+	XASSERT(sWindow == nullptr, "[Platform] Window already created.");
+
+	HINSTANCE instance = GetModuleHandleA(nullptr);
+
+	// Every Windows Window requires at least oen window object. Three things are involved:
+	// 1)	Register a window class.
+	// 2)	Create a window object.
+	// 3)	Retrieve and dispatch messages for this window.
+
+	// Register class
+	WNDCLASSEXA wcex;
+	wcex.cbSize = sizeof(WNDCLASSEXA);
+	wcex.style = CS_HREDRAW | CS_VREDRAW;
+	wcex.lpfnWndProc = WndProc;
+	wcex.cbClsExtra = 0;
+	wcex.cbWndExtra = 0;
+	wcex.hInstance = instance;
+	wcex.hIcon = LoadIconA(nullptr, IDI_APPLICATION);
+	wcex.hCursor = LoadCursorA(nullptr, IDC_ARROW);
+	wcex.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
+	wcex.lpszMenuName = nullptr;
+	wcex.lpszClassName = kWindowClassName;
+	wcex.hIconSm = LoadIconA(nullptr, IDI_APPLICATION);
+
+	XVERIFY(RegisterClassExA(&wcex), "[Window] Failed to register window class.");
+
+	// Compute the correct window dimension
+	RECT rc = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+	AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW, FALSE);
+
+	const int screenWidth = GetSystemMetrics(SM_CXSCREEN);
+	const int screenHeight = GetSystemMetrics(SM_CYSCREEN);
+	const int winWidth = rc.right - rc.left;
+	const int winHeight = rc.bottom - rc.top;
+	const int left = (screenWidth - winWidth) >> 1;
+	const int top = (screenHeight - winHeight) >> 1;
+
+	// Create window
+	sWindow = CreateWindowA
+	(
+		kWindowClassName,
+		title,
+		WS_OVERLAPPEDWINDOW,
+		left,
+		top,
+		winWidth,
+		winHeight,
+		nullptr,
+		nullptr,
+		instance,
+		nullptr
+	);
+
+	if (sWindow == nullptr)
+	{
+		XLOG("[Platform] Failed to create window.");
+		UnregisterClassA(kWindowClassName, instance);
+		return false;
+	}
+
+	ShowWindow(sWindow, true);
+
+	XVERIFY(SetCursorPos(screenWidth >> 1, screenHeight >> 1), "[Window] Failed to set cursor position.");
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::TerminateWindow()
+{
+	if (sWindow == nullptr)
+	{
+		return;
+	}
+
+	// Destroy the window
+	DestroyWindow(sWindow);
+	sWindow = nullptr;
+
+	// Unregister window class
+	UnregisterClassA(kWindowClassName, GetModuleHandleA(nullptr));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void* Platform::GetWindowHandle()
+{
+	return sWindow;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::ProcessMessages()
+{
+	bool quit = false;
+	MSG msg = {};
+	while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE))
+	{
+		TranslateMessage(&msg);
+		DispatchMessageA(&msg);
+
+		if (msg.message == WM_QUIT)
+			quit = true;
+	}
+	return !quit;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::PostQuit()
+{
+	PostQuitMessage(0);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::SetInputSystem(InputSystem* inputSystem)
+{
+	sInputSystem = inputSystem;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::PresentFrame(const Image& frame)
+{
+	if (sWindow == nullptr)
+	{
+		return;
+	}
+
+	// GDI wants BGRA
+	const uint32_t count = frame.width * frame.height;
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(frame.pixels.data());
+	sPresentPixels.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t pixel = src[i];
+		sPresentPixels[i] = (pixel & 0xff00ff00) | ((pixel & 0xff) << 16) | ((pixel >> 16) & 0xff);
+	}
+
+	BITMAPINFO info = {};
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = static_cast<LONG>(frame.width);
+	info.bmiHeader.biHeight = -static_cast<LONG>(frame.height);
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	int width = 0, height = 0;
+	GetClientSize(sWindow, width, height);
+	HDC dc = GetDC(sWindow);
+	StretchDIBits(dc, 0, 0, width, height, 0, 0, frame.width, frame.height, sPresentPixels.data(), &info, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(sWindow, dc);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Platform::ShowSystemCursor(bool show)
+{
+	ShowCursor(show);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::ReadGamePad(int player, GamePadState& state)
+{
+	state = GamePadState();
+	if (!sGamePad)
+	{
+		return false;
+	}
+
+	const DirectX::GamePad::State pad = sGamePad->GetState(player);
+	state.connected = pad.connected;
+	state.buttons =
+		(pad.buttons.a ? GamePadState::A : 0) |
+		(pad.buttons.b ? GamePadState::B : 0) |
+		(pad.buttons.x ? GamePadState::X : 0) |
+		(pad.buttons.y ? GamePadState::Y : 0) |
+		(pad.buttons.leftShoulder ? GamePadState::LeftShoulder : 0) |
+		(pad.buttons.rightShoulder ? GamePadState::RightShoulder : 0) |
+		(pad.dpad.up ? GamePadState::DPadUp : 0) |
+		(pad.dpad.down ? GamePadState::DPadDown : 0) |
+		(pad.dpad.left ? GamePadState::DPadLeft : 0) |
+		(pad.dpad.right ? GamePadState::DPadRight : 0);
+	state.leftX = pad.thumbSticks.leftX;
+	state.leftY = pad.thumbSticks.leftY;
+	state.rightX = pad.thumbSticks.rightX;
+	state.rightY = pad.thumbSticks.rightY;
+	state.leftTrigger = pad.triggers.left;
+	state.rightTrigger = pad.triggers.right;
+	return state.connected;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::OpenFileDialog(char fileName[kMaxPath], const char* title, const char* filter)
+{
+	return RunFileDialog(fileName, title, filter, false);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Platform::SaveFileDialog(char fileName[kMaxPath], const char* title, const char* filter)
+{
+	return RunFileDialog(fileName, title, filter, true);
+}
+
+#endif // #if defined(_WIN32)
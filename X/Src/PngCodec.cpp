@@ -0,0 +1,678 @@
+//====================================================================================================
+// Filename:	PngCodec.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "PngCodec.h"
+
+using namespace X;
+
+namespace
+{
+	constexpr uint8_t kSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	constexpr size_t kMaxStoredBlock = 65535;
+
+	uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+	{
+		static const std::array<uint32_t, 256> table = []()
+		{
+			std::array<uint32_t, 256> result{};
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; ++k)
+				{
+					c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+				}
+				result[i] = c;
+			}
+			return result;
+		}();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; ++i)
+		{
+			crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	void PutU32(std::vector<uint8_t>& data, uint32_t value)
+	{
+		data.push_back(static_cast<uint8_t>(value >> 24));
+		data.push_back(static_cast<uint8_t>(value >> 16));
+		data.push_back(static_cast<uint8_t>(value >> 8));
+		data.push_back(static_cast<uint8_t>(value));
+	}
+
+	void PutChunk(std::vector<uint8_t>& data, const char* type, const std::vector<uint8_t>& payload)
+	{
+		PutU32(data, static_cast<uint32_t>(payload.size()));
+		const size_t start = data.size();
+		data.insert(data.end(), type, type + 4);
+		data.insert(data.end(), payload.begin(), payload.end());
+		PutU32(data, Crc32(&data[start], data.size() - start));
+	}
+
+	uint32_t GetU32(const uint8_t* data)
+	{
+		return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+	}
+
+	// Canonical Huffman decoding as described in RFC 1951, one bit at a time. Fails once the output
+	// would grow past limit bytes.
+	class Inflater
+	{
+	public:
+		Inflater(const uint8_t* data, size_t size, size_t limit)
+			: mData(data)
+			, mSize(size)
+			, mLimit(limit)
+		{}
+
+		bool Inflate(std::vector<uint8_t>& out)
+		{
+			bool last = false;
+			while (!last)
+			{
+				last = Bits(1) != 0;
+				const uint32_t type = Bits(2);
+				bool ok = false;
+				if (type == 0)
+				{
+					ok = Stored(out);
+				}
+				else if (type == 1)
+				{
+					ok = Fixed(out);
+				}
+				else if (type == 2)
+				{
+					ok = Dynamic(out);
+				}
+				if (!ok || mError)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		struct Huffman
+		{
+			uint16_t counts[16];
+			uint16_t symbols[288];
+		};
+
+		uint32_t Bits(int count)
+		{
+			uint32_t value = mBitBuffer;
+			while (mBitCount < count)
+			{
+				if (mPosition == mSize)
+				{
+					mError = true;
+					return 0;
+				}
+				value |= static_cast<uint32_t>(mData[mPosition++]) << mBitCount;
+				mBitCount += 8;
+			}
+			mBitBuffer = value >> count;
+			mBitCount -= count;
+			return value & ((1u << count) - 1);
+		}
+
+		static bool Build(Huffman& huffman, const uint8_t* lengths, int count)
+		{
+			memset(huffman.counts, 0, sizeof(huffman.counts));
+			for (int i = 0; i < count; ++i)
+			{
+				huffman.counts[lengths[i]]++;
+			}
+			if (huffman.counts[0] == count)
+			{
+				return true;
+			}
+
+			// Reject over subscribed codes, incomplete ones are allowed
+			int left = 1;
+			for (int length = 1; length < 16; ++length)
+			{
+				left = (left << 1) - huffman.counts[length];
+				if (left < 0)
+				{
+					return false;
+				}
+			}
+
+			uint16_t offsets[16];
+			offsets[1] = 0;
+			for (int length = 1; length < 15; ++length)
+			{
+				offsets[length + 1] = offsets[length] + huffman.counts[length];
+			}
+			for (int i = 0; i < count; ++i)
+			{
+				if (lengths[i] != 0)
+				{
+					huffman.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+				}
+			}
+			return true;
+		}
+
+		int Decode(const Huffman& huffman)
+		{
+			int code = 0, first = 0, index = 0;
+			for (int length = 1; length < 16; ++length)
+			{
+				code |= static_cast<int>(Bits(1));
+				const int count = huffman.counts[length];
+				if (code - count < first)
+				{
+					return huffman.symbols[index + (code - first)];
+				}
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+			mError = true;
+			return -1;
+		}
+
+		bool Stored(std::vector<uint8_t>& out)
+		{
+			mBitBuffer = 0;
+			mBitCount = 0;
+			if (mPosition + 4 > mSize)
+			{
+				return false;
+			}
+			const uint32_t length = mData[mPosition] | (mData[mPosition + 1] << 8);
+			const uint32_t check = mData[mPosition + 2] | (mData[mPosition + 3] << 8);
+			mPosition += 4;
+			if (length != (~check & 0xffff) || mPosition + length > mSize || out.size() + length > mLimit)
+			{
+				return false;
+			}
+			out.insert(out.end(), mData + mPosition, mData + mPosition + length);
+			mPosition += length;
+			return true;
+		}
+
+		bool Codes(std::vector<uint8_t>& out, const Huffman& literals, const Huffman& distances)
+		{
+			static const uint16_t kLengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static const uint16_t kLengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+			static const uint16_t kDistanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+			static const uint16_t kDistanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+			for (;;)
+			{
+				int symbol = Decode(literals);
+				if (symbol < 0 || mError)
+				{
+					return false;
+				}
+				if (symbol < 256)
+				{
+					if (out.size() == mLimit)
+					{
+						return false;
+					}
+					out.push_back(static_cast<uint8_t>(symbol));
+				}
+				else if (symbol == 256)
+				{
+					return true;
+				}
+				else
+				{
+					symbol -= 257;
+					if (symbol >= 29)
+					{
+						return false;
+					}
+					const uint32_t length = kLengthBase[symbol] + Bits(kLengthExtra[symbol]);
+					const int distanceSymbol = Decode(distances);
+					if (distanceSymbol < 0 || distanceSymbol >= 30)
+					{
+						return false;
+					}
+					const uint32_t distance = kDistanceBase[distanceSymbol] + Bits(kDistanceExtra[distanceSymbol]);
+					if (distance > out.size() || out.size() + length > mLimit)
+					{
+						return false;
+					}
+					// Copies may overlap the bytes they produce
+					size_t from = out.size() - distance;
+					for (uint32_t i = 0; i < length; ++i)
+					{
+						out.push_back(out[from++]);
+					}
+				}
+			}
+		}
+
+		bool Fixed(std::vector<uint8_t>& out)
+		{
+			uint8_t lengths[288 + 30];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			memset(lengths + 288, 5, 30);
+
+			Huffman literals, distances;
+			Build(literals, lengths, 288);
+			Build(distances, lengths + 288, 30);
+			return Codes(out, literals, distances);
+		}
+
+		bool Dynamic(std::vector<uint8_t>& out)
+		{
+			static const uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+			const int literalCount = static_cast<int>(Bits(5)) + 257;
+			const int distanceCount = static_cast<int>(Bits(5)) + 1;
+			const int codeCount = static_cast<int>(Bits(4)) + 4;
+			if (literalCount > 286 || distanceCount > 30)
+			{
+				return false;
+			}
+
+			uint8_t lengths[288 + 30]{};
+			for (int i = 0; i < codeCount; ++i)
+			{
+				lengths[kOrder[i]] = static_cast<uint8_t>(Bits(3));
+			}
+			Huffman codeLengths;
+			if (!Build(codeLengths, lengths, 19))
+			{
+				return false;
+			}
+
+			memset(lengths, 0, sizeof(lengths));
+			int index = 0;
+			while (index < literalCount + distanceCount)
+			{
+				const int symbol = Decode(codeLengths);
+				if (symbol < 0 || mError)
+				{
+					return false;
+				}
+				if (symbol < 16)
+				{
+					lengths[index++] = static_cast<uint8_t>(symbol);
+					continue;
+				}
+
+				uint8_t length = 0;
+				uint32_t repeat = 0;
+				if (symbol == 16)
+				{
+					if (index == 0)
+					{
+						return false;
+					}
+					length = lengths[index - 1];
+					repeat = 3 + Bits(2);
+				}
+				else if (symbol == 17)
+				{
+					repeat = 3 + Bits(3);
+				}
+				else
+				{
+					repeat = 11 + Bits(7);
+				}
+				if (index + static_cast<int>(repeat) > literalCount + distanceCount)
+				{
+					return false;
+				}
+				while (repeat-- > 0)
+				{
+					lengths[index++] = length;
+				}
+			}
+
+			// The end of block code must be present
+			if (lengths[256] == 0)
+			{
+				return false;
+			}
+
+			Huffman literals, distances;
+			if (!Build(literals, lengths, literalCount) || !Build(distances, lengths + literalCount, distanceCount))
+			{
+				return false;
+			}
+			return Codes(out, literals, distances);
+		}
+
+		const uint8_t* mData;
+		size_t mSize;
+		size_t mLimit;
+		size_t mPosition = 0;
+		uint32_t mBitBuffer = 0;
+		int mBitCount = 0;
+		bool mError = false;
+	};
+
+	uint8_t Paeth(int a, int b, int c)
+	{
+		const int p = a + b - c;
+		const int pa = std::abs(p - a);
+		const int pb = std::abs(p - b);
+		const int pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc)
+		{
+			return static_cast<uint8_t>(a);
+		}
+		return static_cast<uint8_t>(pb <= pc ? b : c);
+	}
+
+	// Reverses the per row filters in place, rows are left without their filter byte
+	bool Unfilter(std::vector<uint8_t>& raw, uint32_t height, size_t rowSize, size_t pixelSize)
+	{
+		if (raw.size() < (rowSize + 1) * height)
+		{
+			return false;
+		}
+
+		const uint8_t* prior = nullptr;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			const uint8_t filter = raw[y * (rowSize + 1)];
+			uint8_t* row = &raw[y * rowSize];
+			memmove(row, row + y + 1, rowSize);
+			for (size_t x = 0; x < rowSize; ++x)
+			{
+				const int a = x >= pixelSize ? row[x - pixelSize] : 0;
+				const int b = prior ? prior[x] : 0;
+				const int c = prior && x >= pixelSize ? prior[x - pixelSize] : 0;
+				switch (filter)
+				{
+				case 0: break;
+				case 1: row[x] = static_cast<uint8_t>(row[x] + a); break;
+				case 2: row[x] = static_cast<uint8_t>(row[x] + b); break;
+				case 3: row[x] = static_cast<uint8_t>(row[x] + ((a + b) >> 1)); break;
+				case 4: row[x] = static_cast<uint8_t>(row[x] + Paeth(a, b, c)); break;
+				default: return false;
+				}
+			}
+			prior = row;
+		}
+		return true;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void X::EncodePng(const Image& image, std::vector<uint8_t>& data)
+{
+	data.clear();
+	data.insert(data.end(), std::begin(kSignature), std::end(kSignature));
+
+	std::vector<uint8_t> header;
+	PutU32(header, image.width);
+	PutU32(header, image.height);
+	header.push_back(8); // Bit depth
+	header.push_back(6); // RGBA
+	header.push_back(0); // Deflate
+	header.push_back(0); // Adaptive filtering
+	header.push_back(0); // No interlace
+	PutChunk(data, "IHDR", header);
+
+	// Every row gets a filter byte of 0 (none)
+	const size_t rowSize = image.width * 4;
+	std::vector<uint8_t> raw;
+	raw.reserve((rowSize + 1) * image.height);
+	for (uint32_t y = 0; y < image.height; ++y)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), image.pixels.begin() + y * rowSize, image.pixels.begin() + (y + 1) * rowSize);
+	}
+
+	// zlib stream made of stored blocks, followed by the adler32 of the raw data
+	std::vector<uint8_t> stream;
+	stream.reserve(raw.size() + raw.size() / kMaxStoredBlock * 5 + 16);
+	stream.push_back(0x78);
+	stream.push_back(0x01);
+	size_t offset = 0;
+	do
+	{
+		const size_t size = std::min(raw.size() - offset, kMaxStoredBlock);
+		const bool last = offset + size == raw.size();
+		stream.push_back(last ? 1 : 0);
+		stream.push_back(static_cast<uint8_t>(size));
+		stream.push_back(static_cast<uint8_t>(size >> 8));
+		stream.push_back(static_cast<uint8_t>(~size));
+		stream.push_back(static_cast<uint8_t>(~size >> 8));
+		stream.insert(stream.end(), raw.begin() + offset, raw.begin() + offset + size);
+		offset += size;
+	} while (offset < raw.size());
+
+	uint32_t a = 1, b = 0;
+	for (const uint8_t byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	PutU32(stream, (b << 16) | a);
+	PutChunk(data, "IDAT", stream);
+	PutChunk(data, "IEND", {});
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool X::SavePng(const char* fileName, const Image& image)
+{
+	std::vector<uint8_t> data;
+	EncodePng(image, data);
+
+	FILE* file = Platform::OpenFile(fileName, "wb");
+	if (file == nullptr)
+	{
+		XLOG("[PngCodec] Failed to open %s for writing.", fileName);
+		return false;
+	}
+	const bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+	fclose(file);
+
+	if (!ok)
+	{
+		XLOG("[PngCodec] Failed to write %s.", fileName);
+	}
+	return ok;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool X::DecodePng(const uint8_t* data, size_t size, Image& image)
+{
+	image = Image();
+	if (size < sizeof(kSignature) || memcmp(data, kSignature, sizeof(kSignature)) != 0)
+	{
+		return false;
+	}
+
+	uint32_t width = 0, height = 0;
+	uint8_t bitDepth = 0, colorType = 0, interlace = 0;
+	std::vector<uint8_t> palette;
+	std::vector<uint8_t> transparency;
+	std::vector<uint8_t> stream;
+
+	size_t offset = sizeof(kSignature);
+	while (offset + 12 <= size)
+	{
+		const uint32_t length = GetU32(data + offset);
+		const uint8_t* type = data + offset + 4;
+		const uint8_t* payload = data + offset + 8;
+		if (length > size - offset - 12)
+		{
+			return false;
+		}
+		if (memcmp(type, "IHDR", 4) == 0 && length >= 13)
+		{
+			width = GetU32(payload);
+			height = GetU32(payload + 4);
+			bitDepth = payload[8];
+			colorType = payload[9];
+			interlace = payload[12];
+		}
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			palette.assign(payload, payload + length);
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			transparency.assign(payload, payload + length);
+		}
+		else if (memcmp(type, "IDAT", 4) == 0)
+		{
+			stream.insert(stream.end(), payload, payload + length);
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+		offset += length + 12;
+	}
+
+	int channels = 0;
+	switch (colorType)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	}
+	const bool validDepth = bitDepth == 8 || (bitDepth == 16 && colorType != 3) || (bitDepth < 8 && (colorType == 0 || colorType == 3) && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4));
+	// 1 to 256 RGB entries
+	const bool validPalette = palette.size() >= 3 && palette.size() <= 768 && palette.size() % 3 == 0;
+	if (width == 0 || height == 0 || width > 16384 || height > 16384 || channels == 0 || !validDepth || interlace != 0 || (colorType == 3 && !validPalette))
+	{
+		XLOG("[PngCodec] Unsupported PNG (%ux%u, depth %u, color type %u, interlace %u).", width, height, bitDepth, colorType, interlace);
+		return false;
+	}
+
+	// zlib header: deflate with a window of at most 32K and no preset dictionary
+	if (stream.size() < 2 || (stream[0] & 0x0f) != 8 || (stream[0] >> 4) > 7 || (stream[1] & 0x20) != 0 || ((stream[0] << 8) | stream[1]) % 31 != 0)
+	{
+		return false;
+	}
+
+	const size_t rowSize = (static_cast<size_t>(width) * channels * bitDepth + 7) / 8;
+	const size_t pixelSize = std::max<size_t>(1, channels * bitDepth / 8);
+	std::vector<uint8_t> raw;
+	const size_t rawSize = (rowSize + 1) * height;
+	raw.reserve(rawSize);
+	Inflater inflater(stream.data() + 2, stream.size() - 2, rawSize);
+	if (!inflater.Inflate(raw) || !Unfilter(raw, height, rowSize, pixelSize))
+	{
+		return false;
+	}
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 4);
+	const int step = bitDepth == 16 ? 2 : 1;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint8_t* row = &raw[y * rowSize];
+		uint8_t* dst = &image.pixels[static_cast<size_t>(y) * width * 4];
+		for (uint32_t x = 0; x < width; ++x, dst += 4)
+		{
+			if (bitDepth < 8)
+			{
+				// Packed samples, most significant bits first
+				const uint32_t bit = x * bitDepth;
+				const uint32_t mask = (1u << bitDepth) - 1;
+				const uint32_t value = (row[bit >> 3] >> (8 - bitDepth - (bit & 7))) & mask;
+				if (colorType == 3)
+				{
+					const uint32_t index = std::min<uint32_t>(value, static_cast<uint32_t>(palette.size() / 3) - 1);
+					dst[0] = palette[index * 3];
+					dst[1] = palette[index * 3 + 1];
+					dst[2] = palette[index * 3 + 2];
+					dst[3] = index < transparency.size() ? transparency[index] : 255;
+				}
+				else
+				{
+					const uint8_t gray = static_cast<uint8_t>(value * 255 / mask);
+					dst[0] = dst[1] = dst[2] = gray;
+					dst[3] = 255;
+				}
+				continue;
+			}
+
+			const uint8_t* src = row + static_cast<size_t>(x) * channels * step;
+			switch (colorType)
+			{
+			case 0:
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = 255;
+				break;
+			case 2:
+				dst[0] = src[0];
+				dst[1] = src[step];
+				dst[2] = src[2 * step];
+				dst[3] = 255;
+				break;
+			case 3:
+			{
+				const uint32_t index = std::min<uint32_t>(src[0], static_cast<uint32_t>(palette.size() / 3) - 1);
+				dst[0] = palette[index * 3];
+				dst[1] = palette[index * 3 + 1];
+				dst[2] = palette[index * 3 + 2];
+				dst[3] = index < transparency.size() ? transparency[index] : 255;
+				break;
+			}
+			case 4:
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = src[step];
+				break;
+			case 6:
+				dst[0] = src[0];
+				dst[1] = src[step];
+				dst[2] = src[2 * step];
+				dst[3] = src[3 * step];
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool X::LoadPng(const char* fileName, Image& image)
+{
+	FILE* file = Platform::OpenFile(fileName, "rb");
+	if (file == nullptr)
+	{
+		XLOG("[PngCodec] Failed to open %s.", fileName);
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[65536];
+	size_t read = 0;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + read);
+	}
+	fclose(file);
+
+	if (!DecodePng(data.data(), data.size(), image))
+	{
+		XLOG("[PngCodec] Failed to decode %s.", fileName);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,24 @@
+//====================================================================================================
+// Filename:	PngCodec.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_PNGCODEC_H
+#define INCLUDED_XENGINE_PNGCODEC_H
+
+#include "Image.h"
+
+namespace X {
+
+// Writes an RGBA8 PNG with uncompressed deflate blocks. Output only depends on the pixels, so files
+// can be compared byte for byte.
+void EncodePng(const Image& image, std::vector<uint8_t>& data);
+bool SavePng(const char* fileName, const Image& image);
+
+// Reads any non interlaced PNG into RGBA8. 16 bit channels are truncated to 8 bits.
+bool DecodePng(const uint8_t* data, size_t size, Image& image);
+bool LoadPng(const char* fileName, Image& image);
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_PNGCODEC_H
@@ -6,28 +6,43 @@
 #ifndef INCLUDED_XENGINE_PRECOMPILED_H
 #define INCLUDED_XENGINE_PRECOMPILED_H
 
-#define DIRECTINPUT_VERSION 0x0800
-
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <codecvt>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <list>
 #include <locale>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define DIRECTINPUT_VERSION 0x0800
+
+#include <Windows.h>
+
 #include <d3d11_1.h>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 
 #include <dinput.h>
 
-#include "XCore.h"
-#include "Forward.h"
-
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "D3DCompiler.lib")
 #pragma comment(lib, "dinput8.lib")
 #pragma comment(lib, "dxguid.lib")
+#endif
+
+#include "XCore.h"
+#include "Forward.h"
 
 #endif // #ifndef INCLUDED_XENGINE_PRECOMPILED_H
@@ -0,0 +1,58 @@
+//====================================================================================================
+// Filename:	RadixSort.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "RadixSort.h"
+
+void X::RadixSort(uint64_t* keys, uint64_t* scratch, size_t count)
+{
+	if (count < 2)
+	{
+		return;
+	}
+
+	// Build all histograms in a single read
+	uint32_t histograms[8][256] = {};
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint64_t key = keys[i];
+		for (uint32_t pass = 0; pass < 8; ++pass)
+		{
+			++histograms[pass][(key >> (pass * 8)) & 0xff];
+		}
+	}
+
+	uint64_t* src = keys;
+	uint64_t* dst = scratch;
+	for (uint32_t pass = 0; pass < 8; ++pass)
+	{
+		const uint32_t shift = pass * 8;
+		uint32_t* histogram = histograms[pass];
+		if (histogram[(src[0] >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t digit = 0; digit < 256; ++digit)
+		{
+			const uint32_t digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint64_t key = src[i];
+			dst[histogram[(key >> shift) & 0xff]++] = key;
+		}
+		std::swap(src, dst);
+	}
+
+	if (src != keys)
+	{
+		memcpy(keys, src, count * sizeof(uint64_t));
+	}
+}
@@ -0,0 +1,17 @@
+//====================================================================================================
+// Filename:	RadixSort.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_RADIXSORT_H
+#define INCLUDED_XENGINE_RADIXSORT_H
+
+namespace X {
+
+// Stable LSD radix sort on 64-bit keys, one byte per pass. Passes where every key has the same byte
+// are skipped, so keys that only use a few bytes are cheap. scratch must hold count keys.
+void RadixSort(uint64_t* keys, uint64_t* scratch, size_t count);
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_RADIXSORT_H
@@ -7,16 +7,21 @@
 #include "SimpleDraw.h"
 
 #include "Camera.h"
+#include "SoftwareRenderer.h"
+#include "Vertex.h"
+
+#if defined(_WIN32)
 #include "ConstantBuffer.h"
 #include "GraphicsSystem.h"
 #include "PixelShader.h"
-#include "Vertex.h"
 #include "VertexShader.h"
+#endif
 
 using namespace X;
 
 namespace
 {
+#if defined(_WIN32)
 	const char* kSimpleShader =
 		"cbuffer CBSimpleDraw : register(b0)"
 		"{"
@@ -48,6 +53,126 @@ namespace
 	{
 		Math::Matrix4 transform;
 	};
+#endif
+
+	// Unit circle as a line list of 16 segments, starting at +y and going clockwise like the original
+	// sin/cos loop. Circles are this scaled and offset, no trig per call.
+	constexpr uint32_t kCircleSegments = 16;
+
+	const std::array<Math::Vector2, kCircleSegments * 2>& GetUnitCircle()
+	{
+		static const std::array<Math::Vector2, kCircleSegments * 2> sUnitCircle = []()
+		{
+			std::array<Math::Vector2, kCircleSegments * 2> points;
+			const float kAngle = Math::kTwoPi / kCircleSegments;
+			for (uint32_t i = 0; i < kCircleSegments; ++i)
+			{
+				const float alpha = i * kAngle;
+				const float beta = alpha + kAngle;
+				points[i * 2] = Math::Vector2(sin(alpha), cos(alpha));
+				points[i * 2 + 1] = Math::Vector2(sin(beta), cos(beta));
+			}
+			return points;
+		}();
+		return sUnitCircle;
+	}
+
+	// Line vertices in fixed size pages. Pages are allocated the first time a frame needs them and kept
+	// for the following frames, pages nobody has touched for a while are given back, so memory follows
+	// recent use instead of a worst case reserved up front.
+	class VertexArena
+	{
+	public:
+		void Initialize(uint32_t pageSize)
+		{
+			mPageSize = Math::Max(pageSize, 2u);
+		}
+
+		void Terminate()
+		{
+			mPages.clear();
+			mCurrent = 0;
+			mCount = 0;
+		}
+
+		// Contiguous space for count vertices, larger requests than a page get a page of their own
+		VertexPC32* Allocate(uint32_t count)
+		{
+			while (mCurrent < mPages.size() && mPages[mCurrent].used + count > mPages[mCurrent].capacity)
+			{
+				++mCurrent;
+			}
+			if (mCurrent == mPages.size())
+			{
+				Page& page = mPages.emplace_back();
+				page.capacity = Math::Max(mPageSize, count);
+				page.vertices = std::make_unique<VertexPC32[]>(page.capacity);
+			}
+
+			Page& page = mPages[mCurrent];
+			VertexPC32* vertices = page.vertices.get() + page.used;
+			page.used += count;
+			mCount += count;
+			return vertices;
+		}
+
+		void Reset()
+		{
+			const size_t pagesUsed = mCount > 0 ? mCurrent + 1 : 0;
+			mIdleFrames = pagesUsed < mPages.size() ? mIdleFrames + 1 : 0;
+			if (mIdleFrames >= kTrimFrames)
+			{
+				mPages.resize(pagesUsed);
+				mIdleFrames = 0;
+			}
+
+			for (Page& page : mPages)
+			{
+				page.used = 0;
+			}
+			mCurrent = 0;
+			mCount = 0;
+		}
+
+		template <class Callback>
+		void ForEachPage(Callback callback) const
+		{
+			for (const Page& page : mPages)
+			{
+				if (page.used > 0)
+				{
+					callback(page.vertices.get(), page.used);
+				}
+			}
+		}
+
+		uint32_t GetCount() const		{ return mCount; }
+		uint32_t GetCapacity() const
+		{
+			uint32_t capacity = 0;
+			for (const Page& page : mPages)
+			{
+				capacity += page.capacity;
+			}
+			return capacity;
+		}
+
+	private:
+		static constexpr uint32_t kTrimFrames = 300;
+
+		struct Page
+		{
+			std::unique_ptr<VertexPC32[]> vertices;
+			uint32_t capacity = 0;
+			uint32_t used = 0;
+		};
+
+		std::vector<Page> mPages;
+		size_t mCurrent = 0;
+		uint32_t mPageSize = 0;
+		uint32_t mCount = 0;
+		uint32_t mIdleFrames = 0;
+	};
 
 	class SimpleDrawImpl
 	{
@@ -59,7 +184,7 @@ namespace
 		~SimpleDrawImpl();
 
 		// Functions to startup/shutdown simple draw
-		void Initialize(uint32_t maxVertices);
+		void Initialize(uint32_t pageSize, bool gpu);
 		void Terminate();
 
 		// Function to set transform
@@ -79,38 +204,52 @@ namespace
 		void AddScreenArc(const Math::Vector2& center, float radius, float fromAngle, float toAngle, const Color& color);
 		void AddScreenDiamond(const Math::Vector2& center, float size, const Color& color);
 
-		// Function to render all the lines added
+		// Functions to hand the lines added over to Render, then draw them
+		void Flip();
 		void Render(const Camera& camera);
 
+		uint32_t GetVertexCount2D() const	{ return mVertices2D.GetCount(); }
+		uint32_t GetVertexCount3D() const	{ return mVertices3D.GetCount(); }
+		uint32_t GetVertexCapacity() const	{ return mVertices2D.GetCapacity() + mVertices3D.GetCapacity() + mRender2D.GetCapacity() + mRender3D.GetCapacity(); }
+
 	private:
+		const std::vector<Math::Vector3>& GetUnitSphere(uint32_t slices, uint32_t rings);
+
+#if defined(_WIN32)
+		void DrawPages(const VertexArena& arena, ID3D11Buffer*& buffer, uint32_t& bufferSize);
+
 		VertexShader mVertexShader;
 		PixelShader mPixelShader;
 
 		TypedConstantBuffer<CBSimpleDraw> mConstantBuffer;
 
-		ID3D11Buffer* mVertexBuffer;
-		ID3D11Buffer* mVertexBuffer2D;
+		ID3D11Buffer* mVertexBuffer = nullptr;
+		ID3D11Buffer* mVertexBuffer2D = nullptr;
+		uint32_t mVertexBufferSize = 0;
+		uint32_t mVertexBufferSize2D = 0;
+#endif
+
+		// Lines being added, and the lines from the last Flip waiting for Render
+		VertexArena mVertices3D;
+		VertexArena mVertices2D;
+		VertexArena mRender3D;
+		VertexArena mRender2D;
 
-		VertexPC* mVertices3D;
-		VertexPC* mVertices2D;
+		// Unit sphere line lists keyed by slices << 16 | rings
+		std::unordered_map<uint32_t, std::vector<Math::Vector3>> mUnitSpheres;
 
-		uint32_t mMaxVertices;
-		uint32_t mNumVertices3D;
-		uint32_t mNumVertices2D;
+		uint32_t mPageSize;
 
 		Math::Matrix4 mTransform;
+		Math::Matrix4 mRenderTransform;
 
+		bool mGpu;
 		bool mInitialized;
 	};
 
 	SimpleDrawImpl::SimpleDrawImpl()
-		: mVertexBuffer(nullptr)
-		, mVertexBuffer2D(nullptr)
-		, mVertices3D(nullptr)
-		, mVertices2D(nullptr)
-		, mMaxVertices(0)
-		, mNumVertices2D(0)
-		, mNumVertices3D(0)
+		: mPageSize(0)
+		, mGpu(true)
 		, mInitialized(false)
 	{
 	}
@@ -120,35 +259,33 @@ namespace
 		XASSERT(!mInitialized, "[SimpleDraw] System not shutdown properly.");
 	}
 
-	void SimpleDrawImpl::Initialize(uint32_t maxVertices)
+	void SimpleDrawImpl::Initialize(uint32_t pageSize, bool gpu)
 	{
 		XASSERT(!mInitialized, "[SimpleDraw] Already initialized.");
 
-		const uint32_t kSimpleShaderSize = (uint32_t)strlen(kSimpleShader) + 1;
-		mVertexShader.Initialize(kSimpleShader, kSimpleShaderSize, "VS", "vs_5_0", VertexPC::Format);
-		mPixelShader.Initialize(kSimpleShader, kSimpleShaderSize, "PS", "ps_5_0");
-		mConstantBuffer.Initialize();
-
-		D3D11_BUFFER_DESC bd;
-		ZeroMemory(&bd, sizeof(bd));
-		bd.Usage = D3D11_USAGE_DYNAMIC;
-		bd.ByteWidth = maxVertices * sizeof(VertexPC);
-		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		bd.MiscFlags = 0;
-
-		// Create vertex buffers for 3D/2D lines
-		ID3D11Device* device = GraphicsSystem::Get()->GetDevice();
-		device->CreateBuffer(&bd, nullptr, &mVertexBuffer);
-		device->CreateBuffer(&bd, nullptr, &mVertexBuffer2D);
-
-		// Create line buffers
-		mVertices3D = new VertexPC[maxVertices];
-		mVertices2D = new VertexPC[maxVertices];
+		mGpu = gpu;
+		mPageSize = pageSize;
+#if defined(_WIN32)
+		if (mGpu)
+		{
+			const uint32_t kSimpleShaderSize = (uint32_t)strlen(kSimpleShader) + 1;
+			mVertexShader.Initialize(kSimpleShader, kSimpleShaderSize, "VS", "vs_5_0", VertexPC32::Format);
+			mPixelShader.Initialize(kSimpleShader, kSimpleShaderSize, "PS", "ps_5_0");
+			mConstantBuffer.Initialize();
+
+			// Vertex buffers for 3D/2D lines are created on first use, one page is uploaded at a time
+			mVertexBufferSize = 0;
+			mVertexBufferSize2D = 0;
+		}
+#else
+		XASSERT(!mGpu, "[SimpleDraw] GPU drawing needs D3D11.");
+#endif
 
-		mMaxVertices = maxVertices;
-		mNumVertices3D = 0;
-		mNumVertices2D = 0;
+		// Line pages are allocated as lines are added
+		mVertices3D.Initialize(pageSize);
+		mVertices2D.Initialize(pageSize);
+		mRender3D.Initialize(pageSize);
+		mRender2D.Initialize(pageSize);
 
 		// Set flag
 		mInitialized = true;
@@ -159,15 +296,20 @@ namespace
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
 		// Release everything
-		SafeDeleteArray(mVertices2D);
-		SafeDeleteArray(mVertices3D);
+		mRender2D.Terminate();
+		mRender3D.Terminate();
+		mVertices2D.Terminate();
+		mVertices3D.Terminate();
+		mUnitSpheres.clear();
 
+#if defined(_WIN32)
 		SafeRelease(mVertexBuffer2D);
 		SafeRelease(mVertexBuffer);
 
 		mConstantBuffer.Terminate();
 		mPixelShader.Terminate();
 		mVertexShader.Terminate();
+#endif
 
 		// Clear flag
 		mInitialized = false;
@@ -182,70 +324,62 @@ namespace
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices3D + 2 <= mMaxVertices)
-		{
-			// Add line
-			mVertices3D[mNumVertices3D++] = { v0, color };
-			mVertices3D[mNumVertices3D++] = { v1, color };
-		}
-
-		XASSERT(mNumVertices3D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+		// Add line
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices3D.Allocate(2);
+		v[0] = { v0, c };
+		v[1] = { v1, c };
 	}
 
 	void SimpleDrawImpl::AddAABB(const Math::AABB& aabb, const Color& color)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices3D + 24 <= mMaxVertices)
-		{
-			float minX = aabb.center.x - aabb.extend.x;
-			float minY = aabb.center.y - aabb.extend.y;
-			float minZ = aabb.center.z - aabb.extend.z;
-			float maxX = aabb.center.x + aabb.extend.x;
-			float maxY = aabb.center.y + aabb.extend.y;
-			float maxZ = aabb.center.z + aabb.extend.z;
+		float minX = aabb.center.x - aabb.extend.x;
+		float minY = aabb.center.y - aabb.extend.y;
+		float minZ = aabb.center.z - aabb.extend.z;
+		float maxX = aabb.center.x + aabb.extend.x;
+		float maxY = aabb.center.y + aabb.extend.y;
+		float maxZ = aabb.center.z + aabb.extend.z;
 
-			// Add lines
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, maxZ), color };
+		// Add lines
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices3D.Allocate(24);
+		*v++ = { Math::Vector3(minX, minY, minZ), c };
+		*v++ = { Math::Vector3(minX, minY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, maxZ), color };
+		*v++ = { Math::Vector3(minX, minY, maxZ), c };
+		*v++ = { Math::Vector3(maxX, minY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, minZ), color };
+		*v++ = { Math::Vector3(maxX, minY, maxZ), c };
+		*v++ = { Math::Vector3(maxX, minY, minZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, minZ), color };
+		*v++ = { Math::Vector3(maxX, minY, minZ), c };
+		*v++ = { Math::Vector3(minX, minY, minZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, minZ), color };
+		*v++ = { Math::Vector3(minX, minY, minZ), c };
+		*v++ = { Math::Vector3(minX, maxY, minZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, minY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, maxZ), color };
+		*v++ = { Math::Vector3(minX, minY, maxZ), c };
+		*v++ = { Math::Vector3(minX, maxY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, maxZ), color };
+		*v++ = { Math::Vector3(maxX, minY, maxZ), c };
+		*v++ = { Math::Vector3(maxX, maxY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, minY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, minZ), color };
+		*v++ = { Math::Vector3(maxX, minY, minZ), c };
+		*v++ = { Math::Vector3(maxX, maxY, minZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, maxZ), color };
+		*v++ = { Math::Vector3(minX, maxY, minZ), c };
+		*v++ = { Math::Vector3(minX, maxY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, maxZ), color };
+		*v++ = { Math::Vector3(minX, maxY, maxZ), c };
+		*v++ = { Math::Vector3(maxX, maxY, maxZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, maxZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, minZ), color };
+		*v++ = { Math::Vector3(maxX, maxY, maxZ), c };
+		*v++ = { Math::Vector3(maxX, maxY, minZ), c };
 
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(maxX, maxY, minZ), color };
-			mVertices3D[mNumVertices3D++] = { Math::Vector3(minX, maxY, minZ), color };
-		}
-
-		XASSERT(mNumVertices3D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+		*v++ = { Math::Vector3(maxX, maxY, minZ), c };
+		*v++ = { Math::Vector3(minX, maxY, minZ), c };
 	}
 
 	void SimpleDrawImpl::AddOBB(const Math::OBB& obb, const Color& color)
@@ -290,65 +424,66 @@ namespace
 		AddLine(points[7], points[4], color);
 	}
 
-	void SimpleDrawImpl::AddSphere(const Math::Sphere& sphere, const Color& color, uint32_t slices, uint32_t rings)
+	const std::vector<Math::Vector3>& SimpleDrawImpl::GetUnitSphere(uint32_t slices, uint32_t rings)
 	{
-		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
-
-		const float x = sphere.center.x;
-		const float y = sphere.center.y;
-		const float z = sphere.center.z;
-		const float radius = sphere.radius;
-
-		const uint32_t kSlices = Math::Max(3u, slices);
-		const uint32_t kRings = Math::Max(2u, rings);
-		const uint32_t kLines = (4 * kSlices * kRings) - (2 * kSlices);
+		const uint32_t key = (Math::Min(slices, 0xffffu) << 16) | Math::Min(rings, 0xffffu);
+		std::vector<Math::Vector3>& points = mUnitSpheres[key];
+		if (!points.empty())
+		{
+			return points;
+		}
 
-		// Check if we have enough space
-		if (mNumVertices3D + kLines <= mMaxVertices)
+		// Rings run from pole to pole, each slice adds a meridian segment and a ring segment
+		points.reserve((4 * slices * rings) - (2 * slices));
+		const float kTheta = Math::kPi / (float)rings;
+		const float kPhi = Math::kTwoPi / (float)slices;
+		for (uint32_t j = 0; j < slices; ++j)
 		{
-			// Add lines
-			const float kTheta = Math::kPi / (float)kRings;
-			const float kPhi = Math::kTwoPi / (float)kSlices;
-			for (uint32_t j = 0; j < kSlices; ++j)
+			for (uint32_t i = 0; i < rings; ++i)
 			{
-				for (uint32_t i = 0; i < kRings; ++i)
-				{
-					const float a = i * kTheta;
-					const float b = a + kTheta;
-					const float ay = radius * cos(a);
-					const float by = radius * cos(b);
+				const float a = i * kTheta;
+				const float b = a + kTheta;
+				const float ay = cos(a);
+				const float by = cos(b);
+				const float ar = sin(a);
+				const float br = sin(b);
 
-					const float theta = j * kPhi;
-					const float phi = theta + kPhi;
+				const float theta = j * kPhi;
+				const float phi = theta + kPhi;
 
-					const float ar = sqrt(radius * radius - ay * ay);
-					const float br = sqrt(radius * radius - by * by);
+				const Math::Vector3 p0(ar * sin(theta), ay, ar * cos(theta));
+				const Math::Vector3 p1(br * sin(theta), by, br * cos(theta));
+				const Math::Vector3 p2(br * sin(phi), by, br * cos(phi));
 
-					const float x0 = x + (ar * sin(theta));
-					const float y0 = y + (ay);
-					const float z0 = z + (ar * cos(theta));
+				points.push_back(p0);
+				points.push_back(p1);
 
-					const float x1 = x + (br * sin(theta));
-					const float y1 = y + (by);
-					const float z1 = z + (br * cos(theta));
-
-					const float x2 = x + (br * sin(phi));
-					const float y2 = y + (by);
-					const float z2 = z + (br * cos(phi));
-
-					mVertices3D[mNumVertices3D++] = { Math::Vector3(x0, y0, z0), color };
-					mVertices3D[mNumVertices3D++] = { Math::Vector3(x1, y1, z1), color };
-
-					if (i < kRings - 1)
-					{
-						mVertices3D[mNumVertices3D++] = { Math::Vector3(x1, y1, z1), color };
-						mVertices3D[mNumVertices3D++] = { Math::Vector3(x2, y2, z2), color };
-					}
+				if (i < rings - 1)
+				{
+					points.push_back(p1);
+					points.push_back(p2);
 				}
 			}
 		}
+		return points;
+	}
+
+	void SimpleDrawImpl::AddSphere(const Math::Sphere& sphere, const Color& color, uint32_t slices, uint32_t rings)
+	{
+		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
+
+		const std::vector<Math::Vector3>& unitSphere = GetUnitSphere(Math::Max(3u, slices), Math::Max(2u, rings));
+		const uint32_t count = static_cast<uint32_t>(unitSphere.size());
 
-		XASSERT(mNumVertices3D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+		// Add lines
+		const uint32_t c = PackColor(color);
+		const Math::Vector3 center = sphere.center;
+		const float radius = sphere.radius;
+		VertexPC32* v = mVertices3D.Allocate(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			v[i] = { center + (unitSphere[i] * radius), c };
+		}
 	}
 
 	void SimpleDrawImpl::AddTransform(const Math::Matrix4& transform)
@@ -366,131 +501,130 @@ namespace
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices2D + 2 <= mMaxVertices)
-		{
-			// Add line
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(v0.x, v0.y, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(v1.x, v1.y, 0.0f), color };
-		}
-
-		XASSERT(mNumVertices2D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+		// Add line
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices2D.Allocate(2);
+		v[0] = { Math::Vector3(v0.x, v0.y, 0.0f), c };
+		v[1] = { Math::Vector3(v1.x, v1.y, 0.0f), c };
 	}
 
 	void SimpleDrawImpl::AddScreenRect(const Math::Rect& rect, const Color& color)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices2D + 8 <= mMaxVertices)
-		{
-			float l = rect.left;
-			float t = rect.top;
-			float r = rect.right;
-			float b = rect.bottom;
+		float l = rect.left;
+		float t = rect.top;
+		float r = rect.right;
+		float b = rect.bottom;
 
-			// Add lines
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(l, t, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(r, t, 0.0f), color };
+		// Add lines
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices2D.Allocate(8);
+		*v++ = { Math::Vector3(l, t, 0.0f), c };
+		*v++ = { Math::Vector3(r, t, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(r, t, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(r, b, 0.0f), color };
+		*v++ = { Math::Vector3(r, t, 0.0f), c };
+		*v++ = { Math::Vector3(r, b, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(r, b, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(l, b, 0.0f), color };
+		*v++ = { Math::Vector3(r, b, 0.0f), c };
+		*v++ = { Math::Vector3(l, b, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(l, b, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(l, t, 0.0f), color };
-		}
-
-		XASSERT(mNumVertices2D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+		*v++ = { Math::Vector3(l, b, 0.0f), c };
+		*v++ = { Math::Vector3(l, t, 0.0f), c };
 	}
 
 	void SimpleDrawImpl::AddScreenCircle(const Math::Circle& circle, const Color& color)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices2D + 32 <= mMaxVertices)
-		{
-			float x = circle.center.x;
-			float y = circle.center.y;
-			float r = circle.radius;
+		const std::array<Math::Vector2, kCircleSegments * 2>& unitCircle = GetUnitCircle();
+		const float x = circle.center.x;
+		const float y = circle.center.y;
+		const float r = circle.radius;
 
-			// Add line
-			const float kAngle = Math::kPi / 8.0f;
-			for (uint32_t i = 0; i < 16; ++i)
-			{
-				const float alpha = i * kAngle;
-				const float beta = alpha + kAngle;
-				const float x0 = x + (r * sin(alpha));
-				const float y0 = y + (r * cos(alpha));
-				const float x1 = x + (r * sin(beta));
-				const float y1 = y + (r * cos(beta));
-				mVertices2D[mNumVertices2D++] = { Math::Vector3(x0, y0, 0.0f), color };
-				mVertices2D[mNumVertices2D++] = { Math::Vector3(x1, y1, 0.0f), color };
-			}
+		// Add line
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices2D.Allocate(kCircleSegments * 2);
+		for (uint32_t i = 0; i < kCircleSegments * 2; ++i)
+		{
+			v[i] = { Math::Vector3(x + (r * unitCircle[i].x), y + (r * unitCircle[i].y), 0.0f), c };
 		}
-
-		XASSERT(mNumVertices2D < mMaxVertices, "[SimpleDraw] Too many vertices!");
 	}
 
 	void SimpleDrawImpl::AddScreenArc(const Math::Vector2& center, float radius, float fromAngle, float toAngle, const Color& color)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices2D + 32 <= mMaxVertices)
+		// The start and step differ per call, so rotate by the step instead of a table lookup. Two
+		// sin/cos pairs per arc, the error over 16 steps stays well below a pixel.
+		const float kAngle = (toAngle - fromAngle) / kCircleSegments;
+		const float stepCos = cos(kAngle);
+		const float stepSin = sin(kAngle);
+		float dx = cos(fromAngle);
+		float dy = sin(fromAngle);
+
+		// Add line
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices2D.Allocate(kCircleSegments * 2);
+		for (uint32_t i = 0; i < kCircleSegments; ++i)
 		{
-			float x = center.x;
-			float y = center.y;
-			float r = radius;
-
-			// Add line
-			const float kAngle = (toAngle - fromAngle) / 16.0f;
-			for (uint32_t i = 0; i < 16; ++i)
-			{
-				const float alpha = i * kAngle + fromAngle;
-				const float beta = alpha + kAngle;
-				const float x0 = x + (r * cos(alpha));
-				const float y0 = y + (r * sin(alpha));
-				const float x1 = x + (r * cos(beta));
-				const float y1 = y + (r * sin(beta));
-				mVertices2D[mNumVertices2D++] = { Math::Vector3(x0, y0, 0.0f), color };
-				mVertices2D[mNumVertices2D++] = { Math::Vector3(x1, y1, 0.0f), color };
-			}
+			const float nextX = (dx * stepCos) - (dy * stepSin);
+			const float nextY = (dx * stepSin) + (dy * stepCos);
+			*v++ = { Math::Vector3(center.x + (radius * dx), center.y + (radius * dy), 0.0f), c };
+			*v++ = { Math::Vector3(center.x + (radius * nextX), center.y + (radius * nextY), 0.0f), c };
+			dx = nextX;
+			dy = nextY;
 		}
-
-		XASSERT(mNumVertices2D < mMaxVertices, "[SimpleDraw] Too many vertices!");
 	}
 
 	void SimpleDrawImpl::AddScreenDiamond(const Math::Vector2& center, float size, const Color& color)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
-		// Check if we have enough space
-		if (mNumVertices2D + 8 <= mMaxVertices)
-		{
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x, center.y - size, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x + size, center.y, 0.0f), color };
+		const uint32_t c = PackColor(color);
+		VertexPC32* v = mVertices2D.Allocate(8);
+		*v++ = { Math::Vector3(center.x, center.y - size, 0.0f), c };
+		*v++ = { Math::Vector3(center.x + size, center.y, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x + size, center.y, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x, center.y + size, 0.0f), color };
+		*v++ = { Math::Vector3(center.x + size, center.y, 0.0f), c };
+		*v++ = { Math::Vector3(center.x, center.y + size, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x, center.y + size, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x - size, center.y, 0.0f), color };
+		*v++ = { Math::Vector3(center.x, center.y + size, 0.0f), c };
+		*v++ = { Math::Vector3(center.x - size, center.y, 0.0f), c };
 
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x - size, center.y, 0.0f), color };
-			mVertices2D[mNumVertices2D++] = { Math::Vector3(center.x, center.y - size, 0.0f), color };
-		}
+		*v++ = { Math::Vector3(center.x - size, center.y, 0.0f), c };
+		*v++ = { Math::Vector3(center.x, center.y - size, 0.0f), c };
+	}
 
-		XASSERT(mNumVertices2D < mMaxVertices, "[SimpleDraw] Too many vertices!");
+	void SimpleDrawImpl::Flip()
+	{
+		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
+		XASSERT(mRender3D.GetCount() == 0 && mRender2D.GetCount() == 0, "[SimpleDraw] Lines from the last flip were never rendered.");
+
+		// Render left its pages empty, they take the next frame's lines
+		std::swap(mVertices3D, mRender3D);
+		std::swap(mVertices2D, mRender2D);
+		mRenderTransform = mTransform;
 	}
 
 	void SimpleDrawImpl::Render(const Camera& camera)
 	{
 		XASSERT(mInitialized, "[SimpleDraw] Not initialized.");
 
+		if (!mGpu)
+		{
+			// The software renderer only rasterizes screen space lines
+			SoftwareRenderer* renderer = SoftwareRenderer::Get();
+			mRender2D.ForEachPage([&](const VertexPC32* vertices, uint32_t count)
+			{
+				renderer->DrawLines(vertices, count, mRenderTransform);
+			});
+			mRender3D.Reset();
+			mRender2D.Reset();
+			return;
+		}
+
+#if defined(_WIN32)
 		GraphicsSystem* gs = GraphicsSystem::Get();
 		const uint32_t screenWidth = gs->GetWidth();
 		const uint32_t screenHeight = gs->GetHeight();
@@ -506,20 +640,8 @@ namespace
 		mConstantBuffer.Set(cb);
 		mConstantBuffer.BindVS(0);
 
-		UINT stride = sizeof(VertexPC);
-		UINT offset = 0;
-
-		ID3D11DeviceContext* context = gs->GetContext();
-
 		// Draw 3D lines
-		D3D11_MAPPED_SUBRESOURCE resource;
-		context->Map(mVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-		memcpy(resource.pData, mVertices3D, mNumVertices3D * stride);
-		context->Unmap(mVertexBuffer, 0);
-
-		context->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
-		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-		context->Draw(mNumVertices3D, 0);
+		DrawPages(mRender3D, mVertexBuffer, mVertexBufferSize);
 
 		const uint32_t w = gs->GetWidth();
 		const uint32_t h = gs->GetHeight();
@@ -530,23 +652,55 @@ namespace
 			0.0f, 0.0f, 1.0f, 0.0f,
 			-1.0f, 1.0f, 0.0f, 1.0f
 		);
-		cb.transform = Math::Transpose(mTransform * matInvScreen);
+		cb.transform = Math::Transpose(mRenderTransform * matInvScreen);
 		mConstantBuffer.Set(cb);
 		mConstantBuffer.BindVS(0);
 
 		// Draw 2D lines
-		context->Map(mVertexBuffer2D, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-		memcpy(resource.pData, mVertices2D, mNumVertices2D * stride);
-		context->Unmap(mVertexBuffer2D, 0);
+		DrawPages(mRender2D, mVertexBuffer2D, mVertexBufferSize2D);
+#endif
+
+		// Reset pages
+		mRender3D.Reset();
+		mRender2D.Reset();
+	}
+
+#if defined(_WIN32)
+	void SimpleDrawImpl::DrawPages(const VertexArena& arena, ID3D11Buffer*& buffer, uint32_t& bufferSize)
+	{
+		ID3D11DeviceContext* context = GraphicsSystem::Get()->GetContext();
+		UINT stride = sizeof(VertexPC32);
+		UINT offset = 0;
+
+		arena.ForEachPage([&](const VertexPC32* vertices, uint32_t count)
+		{
+			// Grow the dynamic buffer for the first page, or an oversized one
+			if (count > bufferSize)
+			{
+				SafeRelease(buffer);
+				bufferSize = Math::Max(count, mPageSize);
+
+				D3D11_BUFFER_DESC bd;
+				ZeroMemory(&bd, sizeof(bd));
+				bd.Usage = D3D11_USAGE_DYNAMIC;
+				bd.ByteWidth = bufferSize * sizeof(VertexPC32);
+				bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+				bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+				bd.MiscFlags = 0;
+				GraphicsSystem::Get()->GetDevice()->CreateBuffer(&bd, nullptr, &buffer);
+			}
 
-		context->IASetVertexBuffers(0, 1, &mVertexBuffer2D, &stride, &offset);
-		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-		context->Draw(mNumVertices2D, 0);
+			D3D11_MAPPED_SUBRESOURCE resource;
+			context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+			memcpy(resource.pData, vertices, count * stride);
+			context->Unmap(buffer, 0);
 
-		// Reset index
-		mNumVertices3D = 0;
-		mNumVertices2D = 0;
+			context->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+			context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+			context->Draw(count, 0);
+		});
 	}
+#endif
 
 	SimpleDrawImpl* sSimpleDrawImpl = nullptr;
 }
@@ -555,12 +709,12 @@ namespace
 // Function Definitions
 //====================================================================================================
 
-void SimpleDraw::Initialize(uint32_t maxVertices)
+void SimpleDraw::Initialize(uint32_t pageSize, bool gpu)
 {
 	if (nullptr == sSimpleDrawImpl)
 	{
 		sSimpleDrawImpl = new SimpleDrawImpl();
-		sSimpleDrawImpl->Initialize(maxVertices);
+		sSimpleDrawImpl->Initialize(pageSize, gpu);
 	}
 }
 
@@ -749,8 +903,40 @@ void SimpleDraw::AddScreenDiamond(float x, float y, float size, const Color& col
 
 //----------------------------------------------------------------------------------------------------
 
+void SimpleDraw::Flip()
+{
+	XASSERT(sSimpleDrawImpl != nullptr, "[SimpleDraw] Not initialized.");
+	sSimpleDrawImpl->Flip();
+}
+
+//----------------------------------------------------------------------------------------------------
+
 void SimpleDraw::Render(const Camera& camera)
 {
 	XASSERT(sSimpleDrawImpl != nullptr, "[SimpleDraw] Not initialized.");
 	sSimpleDrawImpl->Render(camera);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t SimpleDraw::GetVertexCount2D()
+{
+	XASSERT(sSimpleDrawImpl != nullptr, "[SimpleDraw] Not initialized.");
+	return sSimpleDrawImpl->GetVertexCount2D();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t SimpleDraw::GetVertexCount3D()
+{
+	XASSERT(sSimpleDrawImpl != nullptr, "[SimpleDraw] Not initialized.");
+	return sSimpleDrawImpl->GetVertexCount3D();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t SimpleDraw::GetVertexCapacity()
+{
+	XASSERT(sSimpleDrawImpl != nullptr, "[SimpleDraw] Not initialized.");
+	return sSimpleDrawImpl->GetVertexCapacity();
 }
\ No newline at end of file
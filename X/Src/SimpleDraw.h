@@ -11,8 +11,9 @@
 namespace X {
 namespace SimpleDraw {
 
-// Functions to startup/shutdown simple draw
-void Initialize(uint32_t maxVertices = 10000);
+// Functions to startup/shutdown simple draw, without a GPU lines are drawn by the software renderer.
+// Vertices are kept in pages of pageSize, there is no upper limit on how many lines can be added.
+void Initialize(uint32_t pageSize = 4096, bool gpu = true);
 void Terminate();
 
 void SetTransform(const Math::Matrix4& transform);
@@ -43,9 +44,18 @@ void AddScreenArc(const Math::Vector2& center, float r, float fromAngle, float t
 void AddScreenDiamond(const Math::Vector2& center, float size, const Math::Vector4& color);
 void AddScreenDiamond(float x, float y, float size, const Math::Vector4& color);
 
-// Function to actually render all the geometry.
+// Flip hands everything added so far over to Render and starts a new set, so one thread can render
+// a frame while the next one is being added. Render draws the set from the last Flip, which has to be
+// rendered before flipping again.
+void Flip();
 void Render(const Camera& camera);
 
+// Functions to query buffer usage, counts are of the set being added and are reset by Flip(). Capacity
+// is the vertices currently backed by pages, 2D and 3D together.
+uint32_t GetVertexCount2D();
+uint32_t GetVertexCount3D();
+uint32_t GetVertexCapacity();
+
 } // namespace SimpleDraw
 } // namespace X
 
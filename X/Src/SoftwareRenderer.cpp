@@ -0,0 +1,410 @@
+//====================================================================================================
+// Filename:	SoftwareRenderer.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "SoftwareRenderer.h"
+
+#include "Blitter.h"
+#include "Font.h"
+#include "Vertex.h"
+
+using namespace X;
+using namespace X::Blitter;
+
+namespace
+{
+	SoftwareRenderer* sSoftwareRenderer = nullptr;
+
+	const Math::Vector2 kPivotOffsets[] =
+	{
+		{ 0.0f, 0.0f }, // TopLeft
+		{ 0.5f, 0.0f }, // Top
+		{ 1.0f, 0.0f }, // TopRight
+		{ 0.0f, 0.5f }, // Left
+		{ 0.5f, 0.5f }, // Center
+		{ 1.0f, 0.5f }, // Right
+		{ 0.0f, 1.0f }, // BottomLeft
+		{ 0.5f, 1.0f }, // Bottom
+		{ 1.0f, 1.0f }, // BottomRight
+	};
+
+	// Liang-Barsky, returns false when the segment is entirely outside [minX, maxX] x [minY, maxY]
+	bool ClipLine(float& x0, float& y0, float& x1, float& y1, float minX, float minY, float maxX, float maxY)
+	{
+		const float dx = x1 - x0;
+		const float dy = y1 - y0;
+		const float p[] = { -dx, dx, -dy, dy };
+		const float q[] = { x0 - minX, maxX - x0, y0 - minY, maxY - y0 };
+		float t0 = 0.0f;
+		float t1 = 1.0f;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (p[i] == 0.0f)
+			{
+				if (q[i] < 0.0f)
+				{
+					return false;
+				}
+				continue;
+			}
+			const float t = q[i] / p[i];
+			if (p[i] < 0.0f)
+			{
+				t0 = std::max(t0, t);
+			}
+			else
+			{
+				t1 = std::min(t1, t);
+			}
+			if (t0 > t1)
+			{
+				return false;
+			}
+		}
+		x1 = x0 + t1 * dx;
+		y1 = y0 + t1 * dy;
+		x0 = x0 + t0 * dx;
+		y0 = y0 + t0 * dy;
+		return true;
+	}
+}
+
+void SoftwareRenderer::StaticInitialize(uint32_t width, uint32_t height)
+{
+	XASSERT(sSoftwareRenderer == nullptr, "[SoftwareRenderer] System already initialized!");
+	sSoftwareRenderer = new SoftwareRenderer();
+	sSoftwareRenderer->Initialize(width, height);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::StaticTerminate()
+{
+	if (sSoftwareRenderer != nullptr)
+	{
+		sSoftwareRenderer->Terminate();
+		SafeDelete(sSoftwareRenderer);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+SoftwareRenderer* SoftwareRenderer::Get()
+{
+	XASSERT(sSoftwareRenderer != nullptr, "[SoftwareRenderer] No instance registered.");
+	return sSoftwareRenderer;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+SoftwareRenderer::SoftwareRenderer()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	XASSERT(mFrameBuffer.pixels.empty(), "[SoftwareRenderer] Renderer not freed.");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::Initialize(uint32_t width, uint32_t height)
+{
+	XASSERT(mFrameBuffer.pixels.empty(), "[SoftwareRenderer] Already initialized.");
+	mFrameBuffer.width = width;
+	mFrameBuffer.height = height;
+	mFrameBuffer.pixels.resize(width * height * 4, 0);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::Terminate()
+{
+	XASSERT(!mFrameBuffer.pixels.empty(), "[SoftwareRenderer] Already terminated.");
+	mFrameBuffer = Image();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::SetTransform(const Math::Matrix4& transform)
+{
+	mTransform = transform;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::BeginRender(const Color& clearColor)
+{
+	uint32_t* pixels = reinterpret_cast<uint32_t*>(mFrameBuffer.pixels.data());
+	std::fill(pixels, pixels + mFrameBuffer.width * mFrameBuffer.height, PackColor(clearColor));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::Draw(const Image& image, const Math::Rect& sourceRect, const Math::Vector2& pos, float rotation, Pivot pivot, Flip flip)
+{
+	// Clamp the source rect to the image
+	const int srcX = std::max(static_cast<int>(sourceRect.left), 0);
+	const int srcY = std::max(static_cast<int>(sourceRect.top), 0);
+	const int width = std::min(static_cast<int>(sourceRect.right), static_cast<int>(image.width)) - srcX;
+	const int height = std::min(static_cast<int>(sourceRect.bottom), static_cast<int>(image.height)) - srcY;
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	const Math::Vector2& offset = kPivotOffsets[static_cast<std::underlying_type_t<Pivot>>(pivot)];
+	const float originX = width * offset.x;
+	const float originY = height * offset.y;
+
+	// Quarter turns (and no rotation) map texels to pixels one to one, anything else is resampled
+	const float quarterTurns = std::round(rotation / Math::kPiByTwo);
+	const bool unscaled = mTransform._11 == 1.0f && mTransform._12 == 0.0f && mTransform._21 == 0.0f && mTransform._22 == 1.0f;
+	if (unscaled && std::abs(rotation - quarterTurns * Math::kPiByTwo) < 1e-4f)
+	{
+		const int turns = static_cast<int>(quarterTurns) & 3;
+		DrawQuarterTurns(image, srcX, srcY, width, height, originX, originY, pos, turns, flip);
+	}
+	else
+	{
+		DrawTransformed(image, srcX, srcY, width, height, originX, originY, pos, rotation, flip);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawQuarterTurns(const Image& image, int srcX, int srcY, int width, int height, float originX, float originY, const Math::Vector2& pos, int turns, Flip flip)
+{
+	// Screen space box of the sprite after rotating about the pivot. Pixel centers decide coverage
+	// like the rasterizer does.
+	const bool sideways = (turns & 1) != 0;
+	const int dstWidth = sideways ? height : width;
+	const int dstHeight = sideways ? width : height;
+	float left = 0.0f, top = 0.0f;
+	switch (turns)
+	{
+	case 0: left = -originX;			top = -originY;				break;
+	case 1: left = originY - height;	top = -originX;				break;
+	case 2: left = originX - width;		top = originY - height;		break;
+	case 3: left = -originY;			top = originX - width;		break;
+	}
+	const int dstX = static_cast<int>(std::ceil(pos.x + left + mTransform._41 - 0.5f));
+	const int dstY = static_cast<int>(std::ceil(pos.y + top + mTransform._42 - 0.5f));
+	const int x0 = std::max(dstX, 0);
+	const int y0 = std::max(dstY, 0);
+	const int x1 = std::min(dstX + dstWidth, static_cast<int>(mFrameBuffer.width));
+	const int y1 = std::min(dstY + dstHeight, static_cast<int>(mFrameBuffer.height));
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+
+	// Texel read for the pixel at (i, j) inside the box, flips mirror the texture not the box
+	const bool flipX = flip == Flip::Horizontal || flip == Flip::Both;
+	const bool flipY = flip == Flip::Vertical || flip == Flip::Both;
+	auto texelOffset = [&](int i, int j)
+	{
+		int u = i, v = j;
+		switch (turns)
+		{
+		case 1: u = j;				v = height - 1 - i;	break;
+		case 2: u = width - 1 - i;	v = height - 1 - j;	break;
+		case 3: u = width - 1 - j;	v = i;				break;
+		}
+		u = flipX ? width - 1 - u : u;
+		v = flipY ? height - 1 - v : v;
+		return static_cast<ptrdiff_t>(srcY + v) * image.width + srcX + u;
+	};
+	const ptrdiff_t base = texelOffset(0, 0);
+	const ptrdiff_t stepX = texelOffset(1, 0) - base;
+	const ptrdiff_t stepY = texelOffset(0, 1) - base;
+
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(image.pixels.data());
+	uint32_t* dst = reinterpret_cast<uint32_t*>(mFrameBuffer.pixels.data());
+	const uint32_t count = static_cast<uint32_t>(x1 - x0);
+	for (int y = y0; y < y1; ++y)
+	{
+		const uint32_t* srcRow = src + base + (y - dstY) * stepY + (x0 - dstX) * stepX;
+		BlendSpan(srcRow, stepX, dst + y * mFrameBuffer.width + x0, count);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawTransformed(const Image& image, int srcX, int srcY, int width, int height, float originX, float originY, const Math::Vector2& pos, float rotation, Flip flip)
+{
+	// Sprite space (texel units, origin at the pivot) to screen: rotate about the pivot, move to pos,
+	// then apply the 2D part of the transform
+	const Math::Matrix4& m = mTransform;
+	const float c = cosf(rotation);
+	const float s = sinf(rotation);
+	const float ax = c * m._11 + s * m._21;
+	const float bx = -s * m._11 + c * m._21;
+	const float ay = c * m._12 + s * m._22;
+	const float by = -s * m._12 + c * m._22;
+	const float tx = pos.x * m._11 + pos.y * m._21 + m._41;
+	const float ty = pos.x * m._12 + pos.y * m._22 + m._42;
+
+	const float det = ax * by - bx * ay;
+	if (det == 0.0f)
+	{
+		return;
+	}
+
+	// Screen bounds of the four corners
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	const float cornersX[] = { -originX, width - originX };
+	const float cornersY[] = { -originY, height - originY };
+	for (float lx : cornersX)
+	{
+		for (float ly : cornersY)
+		{
+			const float sx = ax * lx + bx * ly + tx;
+			const float sy = ay * lx + by * ly + ty;
+			minX = std::min(minX, sx);
+			maxX = std::max(maxX, sx);
+			minY = std::min(minY, sy);
+			maxY = std::max(maxY, sy);
+		}
+	}
+
+	const int x0 = std::max(static_cast<int>(std::ceil(minX - 0.5f)), 0);
+	const int y0 = std::max(static_cast<int>(std::ceil(minY - 0.5f)), 0);
+	const int x1 = std::min(static_cast<int>(std::ceil(maxX - 0.5f)), static_cast<int>(mFrameBuffer.width));
+	const int y1 = std::min(static_cast<int>(std::ceil(maxY - 0.5f)), static_cast<int>(mFrameBuffer.height));
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+
+	// Inverse mapping, step through sprite space one screen pixel at a time with nearest sampling
+	const float invDet = 1.0f / det;
+	const float dudx = by * invDet;
+	const float dvdx = -ay * invDet;
+	const float dudy = -bx * invDet;
+	const float dvdy = ax * invDet;
+
+	const bool flipX = flip == Flip::Horizontal || flip == Flip::Both;
+	const bool flipY = flip == Flip::Vertical || flip == Flip::Both;
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(image.pixels.data());
+	uint32_t* dst = reinterpret_cast<uint32_t*>(mFrameBuffer.pixels.data());
+	for (int y = y0; y < y1; ++y)
+	{
+		const float px = x0 + 0.5f - tx;
+		const float py = y + 0.5f - ty;
+		float u = dudx * px + dudy * py + originX;
+		float v = dvdx * px + dvdy * py + originY;
+		uint32_t* dstRow = dst + y * mFrameBuffer.width;
+		for (int x = x0; x < x1; ++x, u += dudx, v += dvdx)
+		{
+			if (u < 0.0f || v < 0.0f || u >= width || v >= height)
+			{
+				continue;
+			}
+			const int texelX = flipX ? width - 1 - static_cast<int>(u) : static_cast<int>(u);
+			const int texelY = flipY ? height - 1 - static_cast<int>(v) : static_cast<int>(v);
+			dstRow[x] = BlendPixel(src[(srcY + texelY) * image.width + srcX + texelX], dstRow[x]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawLines(const VertexPC32* vertices, uint32_t count, const Math::Matrix4& transform)
+{
+	const Math::Matrix4& m = transform;
+	for (uint32_t i = 0; i + 1 < count; i += 2)
+	{
+		const Math::Vector3& v0 = vertices[i].position;
+		const Math::Vector3& v1 = vertices[i + 1].position;
+		DrawLine(
+			v0.x * m._11 + v0.y * m._21 + m._41,
+			v0.x * m._12 + v0.y * m._22 + m._42,
+			v1.x * m._11 + v1.y * m._21 + m._41,
+			v1.x * m._12 + v1.y * m._22 + m._42,
+			vertices[i].color);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawLine(float x0, float y0, float x1, float y1, uint32_t color)
+{
+	const float maxX = static_cast<float>(mFrameBuffer.width) - 0.5f;
+	const float maxY = static_cast<float>(mFrameBuffer.height) - 0.5f;
+	if (!ClipLine(x0, y0, x1, y1, 0.0f, 0.0f, maxX, maxY))
+	{
+		return;
+	}
+
+	// Bresenham, endpoints are included
+	int ix0 = static_cast<int>(x0);
+	int iy0 = static_cast<int>(y0);
+	const int ix1 = static_cast<int>(x1);
+	const int iy1 = static_cast<int>(y1);
+	const int dx = std::abs(ix1 - ix0);
+	const int dy = -std::abs(iy1 - iy0);
+	const int stepX = ix0 < ix1 ? 1 : -1;
+	const int stepY = iy0 < iy1 ? 1 : -1;
+	int error = dx + dy;
+
+	uint32_t* dst = reinterpret_cast<uint32_t*>(mFrameBuffer.pixels.data());
+	for (;;)
+	{
+		uint32_t& pixel = dst[iy0 * mFrameBuffer.width + ix0];
+		pixel = BlendPixel(color, pixel);
+		if (ix0 == ix1 && iy0 == iy1)
+		{
+			break;
+		}
+		const int error2 = error * 2;
+		if (error2 >= dy)
+		{
+			error += dy;
+			ix0 += stepX;
+		}
+		if (error2 <= dx)
+		{
+			error += dx;
+			iy0 += stepY;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawGlyphs(const Image& atlas, const GlyphQuad* quads, uint32_t count, const Math::Vector2& pos, uint32_t color)
+{
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(atlas.pixels.data());
+	uint32_t* dst = reinterpret_cast<uint32_t*>(mFrameBuffer.pixels.data());
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		// Nearest sample the glyph's cell, scaled to its destination
+		const Math::Rect& source = quads[i].source;
+		const float left = pos.x + quads[i].destination.left;
+		const float top = pos.y + quads[i].destination.top;
+		const float right = pos.x + quads[i].destination.right;
+		const float bottom = pos.y + quads[i].destination.bottom;
+		const int x0 = std::max(static_cast<int>(std::ceil(left - 0.5f)), 0);
+		const int y0 = std::max(static_cast<int>(std::ceil(top - 0.5f)), 0);
+		const int x1 = std::min(static_cast<int>(std::ceil(right - 0.5f)), static_cast<int>(mFrameBuffer.width));
+		const int y1 = std::min(static_cast<int>(std::ceil(bottom - 0.5f)), static_cast<int>(mFrameBuffer.height));
+		const float du = (source.right - source.left) / (right - left);
+		const float dv = (source.bottom - source.top) / (bottom - top);
+		for (int py = y0; py < y1; ++py)
+		{
+			const int texelY = static_cast<int>(source.top + (py + 0.5f - top) * dv);
+			const uint32_t* srcRow = src + texelY * atlas.width;
+			uint32_t* dstRow = dst + py * mFrameBuffer.width;
+			for (int px = x0; px < x1; ++px)
+			{
+				const int texelX = static_cast<int>(source.left + (px + 0.5f - left) * du);
+				dstRow[px] = BlendPixel(Modulate(srcRow[texelX], color), dstRow[px]);
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+//====================================================================================================
+// Filename:	SoftwareRenderer.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_SOFTWARERENDERER_H
+#define INCLUDED_XENGINE_SOFTWARERENDERER_H
+
+#include "Image.h"
+#include "XColors.h"
+#include "XMath.h"
+#include "XTypes.h"
+
+namespace X {
+
+struct GlyphQuad;
+struct VertexPC32;
+
+// Rasterizes sprites, screen lines and text into an RGBA8 framebuffer in memory. Used in place of
+// GraphicsSystem/SpriteRenderer when there is no GPU, e.g. on build servers.
+class SoftwareRenderer
+{
+public:
+	static void StaticInitialize(uint32_t width, uint32_t height);
+	static void StaticTerminate();
+	static SoftwareRenderer* Get();
+
+public:
+	SoftwareRenderer();
+	~SoftwareRenderer();
+
+	SoftwareRenderer(const SoftwareRenderer&) = delete;
+	SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+	void Initialize(uint32_t width, uint32_t height);
+	void Terminate();
+
+	// Only the 2D scale/rotation and translation parts are used
+	void SetTransform(const Math::Matrix4& transform);
+
+	void BeginRender(const Color& clearColor);
+
+	// Same conventions as SpriteRenderer, blending matches the non premultiplied blend state
+	void Draw(const Image& image, const Math::Rect& sourceRect, const Math::Vector2& pos, float rotation = 0.0f, Pivot pivot = Pivot::Center, Flip flip = Flip::None);
+
+	// Draws a line list in screen space
+	void DrawLines(const VertexPC32* vertices, uint32_t count, const Math::Matrix4& transform);
+
+	// Draws glyph quads from a font atlas in screen space, offset by pos and tinted by color (0xAABBGGRR)
+	void DrawGlyphs(const Image& atlas, const GlyphQuad* quads, uint32_t count, const Math::Vector2& pos, uint32_t color);
+
+	const Image& GetFrameBuffer() const	{ return mFrameBuffer; }
+	uint32_t GetWidth() const			{ return mFrameBuffer.width; }
+	uint32_t GetHeight() const			{ return mFrameBuffer.height; }
+
+private:
+	void DrawQuarterTurns(const Image& image, int srcX, int srcY, int width, int height, float originX, float originY, const Math::Vector2& pos, int turns, Flip flip);
+	void DrawTransformed(const Image& image, int srcX, int srcY, int width, int height, float originX, float originY, const Math::Vector2& pos, float rotation, Flip flip);
+	void DrawLine(float x0, float y0, float x1, float y1, uint32_t color);
+
+	Image mFrameBuffer;
+	Math::Matrix4 mTransform;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_SOFTWARERENDERER_H
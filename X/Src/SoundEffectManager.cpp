@@ -7,6 +7,8 @@
 #include "SoundEffectManager.h"
 
 #include "AudioSystem.h"
+#include "ThreadPool.h"
+#include <DirectXTK/Audio/WAVFileReader.h>
 #include <DirectXTK/Inc/Audio.h>
 
 using namespace DirectX;
@@ -17,6 +19,12 @@ namespace
 	SoundEffectManager* sSoundEffectManager = nullptr;
 }
 
+struct SoundEffectManager::WaveFile
+{
+	std::unique_ptr<uint8_t[]> data;
+	WAVData info{};
+};
+
 void SoundEffectManager::StaticInitialize(const char* root)
 {
 	XASSERT(sSoundEffectManager == nullptr, "[SoundEffectManager] Manager already initialized!");
@@ -89,15 +97,102 @@ SoundId SoundEffectManager::Load(const char* fileName)
 
 //----------------------------------------------------------------------------------------------------
 
+SoundId SoundEffectManager::LoadAsync(const char* fileName)
+{
+	std::string fullName = mRoot + "/" + fileName;
+
+	std::hash<std::string> hasher;
+	SoundId hash = hasher(fullName);
+
+	auto result = mInventory.insert({ hash, nullptr });
+	if (result.second)
+	{
+		auto entry = std::make_unique<Entry>();
+		entry->wave = std::make_unique<WaveFile>();
+
+		WaveFile* wave = entry->wave.get();
+		entry->pending = ThreadPool::Get()->Submit([wave, fullName]()
+		{
+			wchar_t wbuffer[1024];
+			mbstowcs_s(nullptr, wbuffer, fullName.c_str(), 1024);
+			HRESULT hr = LoadWAVAudioFromFileEx(wbuffer, wave->data, wave->info);
+			if (FAILED(hr))
+			{
+				XLOG("[SoundEffectManager] Failed to load sound %s. HRESULT: 0x%x", fullName.c_str(), hr);
+				return false;
+			}
+			return true;
+		});
+		result.first->second = std::move(entry);
+		mPending.push_back(hash);
+	}
+
+	return hash;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoundEffectManager::Update()
+{
+	auto iter = mPending.begin();
+	while (iter != mPending.end())
+	{
+		Entry* entry = Find(*iter);
+		if (entry && entry->pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++iter;
+			continue;
+		}
+		if (entry && entry->pending.get())
+		{
+			CreateVoice(*entry);
+		}
+		iter = mPending.erase(iter);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool SoundEffectManager::IsReady(SoundId id) const
+{
+	const Entry* entry = Find(id);
+	return entry && entry->effect;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool SoundEffectManager::IsLoading(SoundId id) const
+{
+	// Update takes the result out of the future once the load has finished, failed or not
+	const Entry* entry = Find(id);
+	return entry && entry->pending.valid();
+}
+
+//----------------------------------------------------------------------------------------------------
+
 void SoundEffectManager::Clear()
 {
+	// Workers may still be writing into entries
+	for (SoundId id : mPending)
+	{
+		Entry* entry = Find(id);
+		if (entry)
+		{
+			entry->pending.wait();
+		}
+	}
+	mPending.clear();
+
 	AudioSystem::Get()->mAudioEngine->Suspend();
 
 	for (auto& item : mInventory)
 	{
 		if (item.second)
 		{
-			item.second->instance->Stop();
+			if (item.second->instance)
+			{
+				item.second->instance->Stop();
+			}
 			item.second->instance.reset();
 			item.second->effect.reset();
 			item.second.reset();
@@ -110,16 +205,16 @@ void SoundEffectManager::Clear()
 
 void SoundEffectManager::Play(SoundId id, bool loop)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	Entry* entry = Find(id);
+	if (entry && entry->effect)
 	{
 		if (loop)
 		{
-			iter->second->instance->Play(true);
+			entry->instance->Play(true);
 		}
 		else
 		{
-			iter->second->effect->Play();
+			entry->effect->Play();
 		}
 	}
 }
@@ -128,8 +223,12 @@ void SoundEffectManager::Play(SoundId id, bool loop)
 
 bool SoundEffectManager::IsPlaying(SoundId id) const
 {
-	auto iter = mInventory.find(id);
-	DirectX::SoundState playing = iter->second->instance->GetState();
+	const Entry* entry = Find(id);
+	if (entry == nullptr || !entry->instance)
+	{
+		return false;
+	}
+	DirectX::SoundState playing = entry->instance->GetState();
 	return playing == DirectX::SoundState::PLAYING;
 }
 
@@ -137,9 +236,27 @@ bool SoundEffectManager::IsPlaying(SoundId id) const
 
 void SoundEffectManager::Stop(SoundId id)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	Entry* entry = Find(id);
+	if (entry && entry->instance)
 	{
-		iter->second->instance->Stop(true);
+		entry->instance->Stop(true);
 	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+SoundEffectManager::Entry* SoundEffectManager::Find(SoundId id) const
+{
+	auto iter = mInventory.find(id);
+	return iter != mInventory.end() ? iter->second.get() : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SoundEffectManager::CreateVoice(Entry& entry)
+{
+	const WAVData& info = entry.wave->info;
+	entry.effect = std::make_unique<SoundEffect>(AudioSystem::Get()->mAudioEngine, entry.wave->data, info.wfx, info.startAudio, info.audioBytes, info.loopStart, info.loopLength);
+	entry.instance = entry.effect->CreateInstance();
+	entry.wave.reset();
 }
\ No newline at end of file
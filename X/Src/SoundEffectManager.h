@@ -31,19 +31,35 @@ public:
 	SoundId Load(const char* fileName);
 	void Clear();
 
+	// Reads and parses the wave file on the thread pool, the voice is created in Update() on the owning
+	// thread. Playing the sound before IsReady() returns true does nothing. A load that fails is no
+	// longer loading but never becomes ready.
+	SoundId LoadAsync(const char* fileName);
+	void Update();
+	bool IsReady(SoundId id) const;
+	bool IsLoading(SoundId id) const;
+
 	void Play(SoundId id, bool loop = false);
 	void Stop(SoundId id);
 	bool IsPlaying(SoundId id) const;
 
 private:
+	struct WaveFile;
+
 	struct Entry
 	{
 		std::unique_ptr<DirectX::SoundEffect> effect;
 		std::unique_ptr<DirectX::SoundEffectInstance> instance;
+		std::unique_ptr<WaveFile> wave;
+		std::future<bool> pending;
 	};
 
+	Entry* Find(SoundId id) const;
+	void CreateVoice(Entry& entry);
+
 	std::string mRoot;
 	std::unordered_map<std::size_t, std::unique_ptr<Entry>> mInventory;
+	std::vector<SoundId> mPending;
 };
 
 } // namespace Graphics
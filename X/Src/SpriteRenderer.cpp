@@ -6,8 +6,10 @@
 #include "Precompiled.h"
 #include "SpriteRenderer.h"
 
+#include "Font.h"
 #include "GraphicsSystem.h"
 #include "Texture.h"
+#include <DirectXPackedVector.h>
 #include <DirectXTK/Inc/CommonStates.h>
 #include <DirectXTK/Inc/SpriteBatch.h>
 
@@ -178,4 +180,27 @@ void SpriteRenderer::Draw(const Texture& texture, const Math::Rect& sourceRect,
 	DirectX::XMFLOAT2 origin = GetOrigin(rect.right - rect.left, rect.bottom - rect.top, pivot);
 	DirectX::SpriteEffects effects = GetSpriteEffects(flip);
 	mSpriteBatch->Draw(texture.mShaderResourceView, ToXMFLOAT2(pos), &rect, DirectX::Colors::White, rotation, origin, 1.0f, effects);
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------------------------------
+void SpriteRenderer::DrawGlyphs(const Texture& atlas, const GlyphQuad* quads, uint32_t count, const Math::Vector2& pos, uint32_t color)
+{
+	XASSERT(mSpriteBatch != nullptr, "[SpriteRenderer] Not initialized.");
+	const DirectX::PackedVector::XMUBYTEN4 packed(color);
+	const DirectX::XMVECTOR tint = DirectX::PackedVector::XMLoadUByteN4(&packed);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const Math::Rect& source = quads[i].source;
+		const Math::Rect& destination = quads[i].destination;
+		RECT rect;
+		rect.left = static_cast<LONG>(source.left);
+		rect.top = static_cast<LONG>(source.top);
+		rect.right = static_cast<LONG>(source.right);
+		rect.bottom = static_cast<LONG>(source.bottom);
+		const DirectX::XMFLOAT2 position(pos.x + destination.left, pos.y + destination.top);
+		const DirectX::XMFLOAT2 scale(
+			(destination.right - destination.left) / (source.right - source.left),
+			(destination.bottom - destination.top) / (source.bottom - source.top));
+		mSpriteBatch->Draw(atlas.mShaderResourceView, position, &rect, tint, 0.0f, DirectX::XMFLOAT2(0.0f, 0.0f), scale);
+	}
+}
@@ -13,6 +13,7 @@ namespace DirectX {	class CommonStates; class SpriteBatch; }
 
 namespace X {
 
+struct GlyphQuad;
 class Texture;
 
 class SpriteRenderer
@@ -40,9 +41,10 @@ public:
 	void Draw(const Texture& texture, const Math::Vector2& pos, float rotation = 0.0f, Pivot pivot = Pivot::Center, Flip flip = Flip::None);
 	void Draw(const Texture& texture, const Math::Rect& sourceRect, const Math::Vector2& pos, float rotation = 0.0f, Pivot pivot = Pivot::Center, Flip flip = Flip::None);
 
-private:
-	friend class Font;
+	// Glyph quads from a font atlas offset by pos and tinted by color (0xAABBGGRR), queued in the sprite batch
+	void DrawGlyphs(const Texture& atlas, const GlyphQuad* quads, uint32_t count, const Math::Vector2& pos, uint32_t color);
 
+private:
 	DirectX::CommonStates* mCommonStates;
 	DirectX::SpriteBatch* mSpriteBatch;
 
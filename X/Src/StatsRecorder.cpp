@@ -0,0 +1,344 @@
+//====================================================================================================
+// Filename:	StatsRecorder.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "StatsRecorder.h"
+
+using namespace X;
+
+namespace
+{
+	std::atomic<uint64_t> sAllocationCount{ 0 };
+
+	constexpr uint32_t kQueueSize = 1024;
+	constexpr uint32_t kEventLength = 32;
+
+	struct Record
+	{
+		FrameStats stats;
+		char event[kEventLength];
+	};
+
+	// Single producer (main thread), single consumer (writer thread)
+	struct Recorder
+	{
+		std::array<Record, kQueueSize> queue;
+		std::atomic<uint32_t> head{ 0 };
+		std::atomic<uint32_t> tail{ 0 };
+		std::atomic<bool> running{ false };
+		std::thread writer;
+
+		FILE* file = nullptr;
+		bool json = false;
+		bool firstRecord = true;
+
+		char pendingEvent[kEventLength]{};
+		uint32_t dropped = 0;
+	};
+
+	Recorder* sRecorder = nullptr;
+
+	// Event names come from the game, quote them so commas, quotes and control characters can't break
+	// the file. CSV doubles quotes, JSON escapes them.
+	void WriteEvent(FILE* file, const char* event, bool json)
+	{
+		fputc('"', file);
+		for (const char* c = event; *c != '\0'; ++c)
+		{
+			const unsigned char ch = static_cast<unsigned char>(*c);
+			if (!json)
+			{
+				if (ch == '"')
+				{
+					fputc('"', file);
+				}
+				fputc(ch, file);
+			}
+			else if (ch == '"' || ch == '\\')
+			{
+				fputc('\\', file);
+				fputc(ch, file);
+			}
+			else if (ch < 0x20)
+			{
+				fprintf(file, "\\u%04x", ch);
+			}
+			else
+			{
+				fputc(ch, file);
+			}
+		}
+		fputc('"', file);
+	}
+
+	void WriteRecord(Recorder& recorder, const Record& record)
+	{
+		const FrameStats& s = record.stats;
+		if (recorder.json)
+		{
+			fprintf(recorder.file, "%s\n\t{ \"frame\": %llu, \"frameTime\": %.3f, \"simulationTime\": %.3f, \"renderTime\": %.3f, "
+				"\"spriteCommands\": %u, \"textureChanges\": %u, \"textCommands\": %u, \"vertices2D\": %u, \"vertices3D\": %u, "
+				"\"audioVoices\": %u, \"allocations\": %u, \"event\": ",
+				recorder.firstRecord ? "" : ",",
+				static_cast<unsigned long long>(s.frame), s.frameTime, s.simulationTime, s.renderTime,
+				s.spriteCommands, s.textureChanges, s.textCommands, s.vertices2D, s.vertices3D,
+				s.audioVoices, s.allocations);
+			WriteEvent(recorder.file, record.event, true);
+			fputs(" }", recorder.file);
+		}
+		else
+		{
+			fprintf(recorder.file, "%llu,%.3f,%.3f,%.3f,%u,%u,%u,%u,%u,%u,%u,",
+				static_cast<unsigned long long>(s.frame), s.frameTime, s.simulationTime, s.renderTime,
+				s.spriteCommands, s.textureChanges, s.textCommands, s.vertices2D, s.vertices3D,
+				s.audioVoices, s.allocations);
+			WriteEvent(recorder.file, record.event, false);
+			fputc('\n', recorder.file);
+		}
+		recorder.firstRecord = false;
+	}
+
+	void Drain(Recorder& recorder)
+	{
+		uint32_t tail = recorder.tail.load(std::memory_order_relaxed);
+		const uint32_t head = recorder.head.load(std::memory_order_acquire);
+		while (tail != head)
+		{
+			WriteRecord(recorder, recorder.queue[tail % kQueueSize]);
+			++tail;
+		}
+		recorder.tail.store(tail, std::memory_order_release);
+	}
+
+	void WriterThread(Recorder& recorder)
+	{
+		while (recorder.running.load(std::memory_order_acquire))
+		{
+			Drain(recorder);
+			fflush(recorder.file);
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+		Drain(recorder);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+// Allocation tracking, every global new in the process goes through here
+
+namespace
+{
+	// Alignments up to the default new alignment come from malloc, so they can go back through free
+	void* Allocate(std::size_t size, std::size_t alignment)
+	{
+		sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+		size = size ? size : 1;
+		for (;;)
+		{
+			void* memory = nullptr;
+			if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			{
+				memory = std::malloc(size);
+			}
+			else
+			{
+#if defined(_WIN32)
+				memory = _aligned_malloc(size, alignment);
+#else
+				if (posix_memalign(&memory, alignment, size) != 0)
+				{
+					memory = nullptr;
+				}
+#endif
+			}
+			if (memory != nullptr)
+			{
+				return memory;
+			}
+			std::new_handler handler = std::get_new_handler();
+			if (handler == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+			handler();
+		}
+	}
+
+	void FreeAligned(void* memory)
+	{
+#if defined(_WIN32)
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return Allocate(size, 0);
+}
+
+void* operator new[](std::size_t size)
+{
+	return Allocate(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept
+{
+	if (static_cast<std::size_t>(alignment) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+	{
+		std::free(memory);
+	}
+	else
+	{
+		FreeAligned(memory);
+	}
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StatsRecorder::Initialize(const char* fileName)
+{
+	XASSERT(sRecorder == nullptr, "[StatsRecorder] Already initialized.");
+	if (fileName == nullptr || fileName[0] == '\0')
+	{
+		return;
+	}
+
+	FILE* file = Platform::OpenFile(fileName, "w");
+	if (file == nullptr)
+	{
+		XLOG("[StatsRecorder] Failed to open %s for writing.", fileName);
+		return;
+	}
+
+	const size_t length = strlen(fileName);
+	sRecorder = new Recorder();
+	sRecorder->file = file;
+	sRecorder->json = length >= 5 && Platform::CompareNoCase(fileName + length - 5, ".json") == 0;
+	if (sRecorder->json)
+	{
+		fputs("[", file);
+	}
+	else
+	{
+		fputs("frame,frameTime,simulationTime,renderTime,spriteCommands,textureChanges,textCommands,vertices2D,vertices3D,audioVoices,allocations,event\n", file);
+	}
+
+	sRecorder->running = true;
+	sRecorder->writer = std::thread(WriterThread, std::ref(*sRecorder));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StatsRecorder::Terminate()
+{
+	if (sRecorder == nullptr)
+	{
+		return;
+	}
+
+	sRecorder->running.store(false, std::memory_order_release);
+	sRecorder->writer.join();
+
+	if (sRecorder->json)
+	{
+		fputs("\n]\n", sRecorder->file);
+	}
+	fclose(sRecorder->file);
+
+	if (sRecorder->dropped > 0)
+	{
+		XLOG("[StatsRecorder] Dropped %u frames, writer could not keep up.", sRecorder->dropped);
+	}
+	SafeDelete(sRecorder);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t StatsRecorder::GetAllocationCount()
+{
+	return sAllocationCount.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StatsRecorder::MarkEvent(const char* name)
+{
+	// Same thread as Submit, the pending event is not synchronized
+	if (sRecorder != nullptr)
+	{
+		snprintf(sRecorder->pendingEvent, sizeof(sRecorder->pendingEvent), "%s", name);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StatsRecorder::Submit(const FrameStats& stats)
+{
+	if (sRecorder == nullptr)
+	{
+		return;
+	}
+
+	const uint32_t head = sRecorder->head.load(std::memory_order_relaxed);
+	if (head - sRecorder->tail.load(std::memory_order_acquire) >= kQueueSize)
+	{
+		++sRecorder->dropped;
+	}
+	else
+	{
+		Record& record = sRecorder->queue[head % kQueueSize];
+		record.stats = stats;
+		memcpy(record.event, sRecorder->pendingEvent, kEventLength);
+		sRecorder->head.store(head + 1, std::memory_order_release);
+	}
+	sRecorder->pendingEvent[0] = '\0';
+}
@@ -0,0 +1,33 @@
+//====================================================================================================
+// Filename:	StatsRecorder.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_STATSRECORDER_H
+#define INCLUDED_XENGINE_STATSRECORDER_H
+
+#include "XTypes.h"
+
+namespace X {
+namespace StatsRecorder {
+
+// Starts the writer thread when fileName is not empty. Files ending in .json are written as a JSON
+// array, anything else as CSV.
+void Initialize(const char* fileName);
+void Terminate();
+
+// Number of global operator new calls since startup, array and aligned forms included
+uint64_t GetAllocationCount();
+
+// Tags the current frame with a gameplay event, the last mark of a frame wins. Only call it from the
+// thread that calls Submit.
+void MarkEvent(const char* name);
+
+// Hands a finished frame to the writer thread. Never blocks, frames are dropped if the writer falls
+// too far behind.
+void Submit(const FrameStats& stats);
+
+} // namespace StatsRecorder
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_STATSRECORDER_H
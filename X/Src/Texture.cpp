@@ -6,9 +6,11 @@
 #include "Precompiled.h"
 #include "Texture.h"
 
+#if defined(_WIN32)
 #include "GraphicsSystem.h"
 #include <DirectXTK/Inc/DDSTextureLoader.h>
 #include <DirectXTK/Inc/WICTextureLoader.h>
+#endif
 
 using namespace X;
 
@@ -26,6 +28,8 @@ Texture::~Texture()
 	XASSERT(mShaderResourceView == nullptr, "[Texture] Texture not released!");
 }
 
+#if defined(_WIN32)
+
 //----------------------------------------------------------------------------------------------------
 
 bool Texture::Initialize(const char* fileName)
@@ -106,6 +110,9 @@ bool Texture::Initialize(const void* data, uint32_t width, uint32_t height)
 	}
 
 	SafeRelease(texture);
+
+	mWidth = width;
+	mHeight = height;
 	return true;
 }
 
@@ -128,4 +135,44 @@ void Texture::BindVS(uint32_t index)
 void Texture::BindPS(uint32_t index)
 {
 	GraphicsSystem::Get()->GetContext()->PSSetShaderResources(index, 1, &mShaderResourceView);
-}
\ No newline at end of file
+}
+
+#else
+
+// There is no device to create textures on, TextureManager keeps images on the CPU instead
+
+//----------------------------------------------------------------------------------------------------
+
+bool Texture::Initialize(const char* fileName)
+{
+	XLOG("[Texture] No GPU on this platform, failed to load texture %s.", fileName);
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Texture::Initialize(const void* data, uint32_t width, uint32_t height)
+{
+	XLOG("[Texture] No GPU on this platform, failed to create texture.");
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Texture::Terminate()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Texture::BindVS(uint32_t index)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Texture::BindPS(uint32_t index)
+{
+}
+
+#endif // #if defined(_WIN32)
\ No newline at end of file
@@ -6,6 +6,10 @@
 #ifndef INCLUDED_XENGINE_TEXTURE_H
 #define INCLUDED_XENGINE_TEXTURE_H
 
+#if !defined(_WIN32)
+struct ID3D11ShaderResourceView;
+#endif
+
 namespace X {
 
 class Texture
@@ -0,0 +1,200 @@
+//====================================================================================================
+// Filename:	TextureAtlas.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "TextureAtlas.h"
+
+// ImGui compiles its own copy of the packer as static, so we need one for this translation unit too
+#define STBRP_STATIC
+#define STBRP_ASSERT(x) XASSERT(x, "[TextureAtlas] Rect pack assert.")
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <ImGui/Src/imstb_rectpack.h>
+
+using namespace X;
+
+namespace
+{
+	constexpr uint32_t kCacheMagic = 0x4c544158; // "XATL"
+	constexpr uint32_t kCacheVersion = 1;
+	constexpr uint32_t kGutter = 1;
+
+	template <class T>
+	bool Write(FILE* file, const T& value)
+	{
+		return fwrite(&value, sizeof(T), 1, file) == 1;
+	}
+
+	template <class T>
+	bool Read(FILE* file, T& value)
+	{
+		return fread(&value, sizeof(T), 1, file) == 1;
+	}
+
+	void Blit(const Image& source, Image& page, uint32_t x, uint32_t y)
+	{
+		const size_t rowSize = source.width * 4;
+		for (uint32_t row = 0; row < source.height; ++row)
+		{
+			const uint8_t* src = source.pixels.data() + row * rowSize;
+			uint8_t* dst = page.pixels.data() + ((y + row) * page.width + x) * 4;
+			memcpy(dst, src, rowSize);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureAtlas::Pack(const std::vector<const Image*>& images, uint32_t pageSize, std::vector<Placement>& placements, std::vector<Image>& pages)
+{
+	placements.clear();
+	placements.resize(images.size());
+	pages.clear();
+
+	std::vector<stbrp_rect> rects;
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		const Image& image = *images[i];
+		if (image.width + kGutter <= pageSize && image.height + kGutter <= pageSize)
+		{
+			stbrp_rect rect{};
+			rect.id = static_cast<int>(i);
+			rect.w = static_cast<stbrp_coord>(image.width + kGutter);
+			rect.h = static_cast<stbrp_coord>(image.height + kGutter);
+			rects.push_back(rect);
+		}
+	}
+
+	std::vector<stbrp_node> nodes(pageSize);
+	while (!rects.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, pageSize, pageSize, nodes.data(), static_cast<int>(nodes.size()));
+		stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()));
+
+		const uint32_t page = static_cast<uint32_t>(pages.size());
+		uint32_t pageHeight = 0;
+		for (const auto& rect : rects)
+		{
+			if (rect.was_packed)
+			{
+				Placement& placement = placements[rect.id];
+				placement.page = page;
+				placement.x = rect.x;
+				placement.y = rect.y;
+				placement.width = images[rect.id]->width;
+				placement.height = images[rect.id]->height;
+				pageHeight = std::max(pageHeight, placement.y + placement.height);
+			}
+		}
+
+		pages.emplace_back();
+		Image& image = pages.back();
+		image.width = pageSize;
+		image.height = pageHeight;
+		image.pixels.resize(pageSize * pageHeight * 4, 0);
+		for (const auto& rect : rects)
+		{
+			if (rect.was_packed)
+			{
+				Blit(*images[rect.id], image, rect.x, rect.y);
+			}
+		}
+
+		rects.erase(std::remove_if(rects.begin(), rects.end(), [](const stbrp_rect& rect) { return rect.was_packed != 0; }), rects.end());
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureAtlas::SaveCache(const char* fileName, const std::vector<CacheEntry>& entries, const std::vector<Image>& pages)
+{
+	FILE* file = Platform::OpenFile(fileName, "wb");
+	if (file == nullptr)
+	{
+		XLOG("[TextureAtlas] Failed to open %s for writing.", fileName);
+		return false;
+	}
+
+	bool ok = Write(file, kCacheMagic) && Write(file, kCacheVersion);
+	ok = ok && Write(file, static_cast<uint32_t>(entries.size())) && Write(file, static_cast<uint32_t>(pages.size()));
+	for (const auto& entry : entries)
+	{
+		ok = ok && Write(file, static_cast<uint32_t>(entry.name.size()));
+		ok = ok && fwrite(entry.name.data(), 1, entry.name.size(), file) == entry.name.size();
+		ok = ok && Write(file, entry.fileSize) && Write(file, entry.fileTime) && Write(file, entry.placement);
+	}
+	for (const auto& page : pages)
+	{
+		ok = ok && Write(file, page.width) && Write(file, page.height);
+		ok = ok && fwrite(page.pixels.data(), 1, page.pixels.size(), file) == page.pixels.size();
+	}
+	fclose(file);
+
+	if (!ok)
+	{
+		XLOG("[TextureAtlas] Failed to write atlas cache %s.", fileName);
+		remove(fileName);
+	}
+	return ok;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureAtlas::LoadCache(const char* fileName, std::vector<CacheEntry>& entries, std::vector<Image>& pages)
+{
+	entries.clear();
+	pages.clear();
+
+	FILE* file = Platform::OpenFile(fileName, "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	uint32_t magic = 0, version = 0, entryCount = 0, pageCount = 0;
+	bool ok = Read(file, magic) && Read(file, version) && magic == kCacheMagic && version == kCacheVersion;
+	ok = ok && Read(file, entryCount) && Read(file, pageCount);
+	for (uint32_t i = 0; ok && i < entryCount; ++i)
+	{
+		entries.emplace_back();
+		CacheEntry& entry = entries.back();
+		uint32_t length = 0;
+		ok = Read(file, length) && length < 1024;
+		if (ok)
+		{
+			entry.name.resize(length);
+			ok = fread(&entry.name[0], 1, length, file) == length;
+		}
+		ok = ok && Read(file, entry.fileSize) && Read(file, entry.fileTime) && Read(file, entry.placement);
+		ok = ok && entry.placement.page < pageCount;
+	}
+	for (uint32_t i = 0; ok && i < pageCount; ++i)
+	{
+		pages.emplace_back();
+		Image& page = pages.back();
+		ok = Read(file, page.width) && Read(file, page.height) && page.width <= 16384 && page.height <= 16384;
+		if (ok)
+		{
+			page.pixels.resize(page.width * page.height * 4);
+			ok = fread(page.pixels.data(), 1, page.pixels.size(), file) == page.pixels.size();
+		}
+	}
+	fclose(file);
+
+	for (size_t i = 0; ok && i < entries.size(); ++i)
+	{
+		const Placement& placement = entries[i].placement;
+		const Image& page = pages[placement.page];
+		ok = placement.x + placement.width <= page.width && placement.y + placement.height <= page.height;
+	}
+
+	if (!ok)
+	{
+		XLOG("[TextureAtlas] Atlas cache %s is invalid, it will be rebuilt.", fileName);
+		entries.clear();
+		pages.clear();
+	}
+	return ok;
+}
@@ -0,0 +1,44 @@
+//====================================================================================================
+// Filename:	TextureAtlas.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_TEXTUREATLAS_H
+#define INCLUDED_XENGINE_TEXTUREATLAS_H
+
+#include "Image.h"
+
+namespace X {
+namespace TextureAtlas {
+
+constexpr uint32_t kInvalidPage = 0xffffffff;
+
+struct Placement
+{
+	uint32_t page = kInvalidPage;
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+// Identifies the source file of a packed image so stale cache entries can be detected
+struct CacheEntry
+{
+	std::string name;
+	uint64_t fileSize = 0;
+	uint64_t fileTime = 0;
+	Placement placement;
+};
+
+// Packs the images into as few pageSize x pageSize pages as possible with a 1 pixel gutter between
+// them. Page heights are trimmed to the space used. Images larger than a page are left unplaced.
+void Pack(const std::vector<const Image*>& images, uint32_t pageSize, std::vector<Placement>& placements, std::vector<Image>& pages);
+
+bool SaveCache(const char* fileName, const std::vector<CacheEntry>& entries, const std::vector<Image>& pages);
+bool LoadCache(const char* fileName, std::vector<CacheEntry>& entries, std::vector<Image>& pages);
+
+} // namespace TextureAtlas
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_TEXTUREATLAS_H
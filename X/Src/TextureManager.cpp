@@ -7,18 +7,28 @@
 #include "TextureManager.h"
 
 #include "Texture.h"
+#include "ThreadPool.h"
 
 using namespace X;
 
 namespace
 {
 	TextureManager* sTextureManager = nullptr;
+
+	void ReleaseTexture(std::unique_ptr<Texture>& texture)
+	{
+		if (texture)
+		{
+			texture->Terminate();
+			texture.reset();
+		}
+	}
 }
 
-void TextureManager::StaticInitialize(const char* root)
+void TextureManager::StaticInitialize(const char* root, bool gpu)
 {
 	XASSERT(sTextureManager == nullptr, "[TextureManager] Manager already initialized!");
-	sTextureManager = new TextureManager();
+	sTextureManager = new TextureManager(gpu);
 	sTextureManager->SetRootPath(root);
 }
 
@@ -43,15 +53,18 @@ TextureManager* TextureManager::Get()
 
 //----------------------------------------------------------------------------------------------------
 
-TextureManager::TextureManager()
+TextureManager::TextureManager(bool gpu)
+	: mGpu(gpu)
 {
+	// Slot 0 is reserved so a valid handle is never 0
+	mSlots.resize(1);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 TextureManager::~TextureManager()
 {
-	XASSERT(mInventory.empty(), "[TextureManager] Clear() must be called to clean up.");
+	XASSERT(mNames.empty(), "[TextureManager] Clear() must be called to clean up.");
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -63,55 +76,363 @@ void TextureManager::SetRootPath(const char* path)
 
 //----------------------------------------------------------------------------------------------------
 
+void TextureManager::EnableAtlas(uint32_t pageSize, const char* cacheFileName)
+{
+	XASSERT(mNames.empty(), "[TextureManager] Atlas must be enabled before loading textures.");
+	mPageSize = pageSize;
+	mCacheFileName = cacheFileName ? cacheFileName : "";
+
+	// Pages from the cache are uploaded now so cached textures never need to be decoded
+	if (!mCacheFileName.empty() && TextureAtlas::LoadCache(mCacheFileName.c_str(), mCacheEntries, mCachePages))
+	{
+		CreatePages(mCachePages);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureManager::BuildAtlas()
+{
+	// Async loads issued during init have to land before packing
+	FinishPending(true);
+
+	mAtlasBuilt = true;
+	if (!mAtlasDirty)
+	{
+		mCacheEntries.clear();
+		mCachePages.clear();
+		return;
+	}
+
+	// Gather the pixels of every packable texture, cached ones are copied back out of their old page
+	std::vector<Entry*> entries;
+	std::vector<const Image*> images;
+	for (auto& slot : mSlots)
+	{
+		Entry* entry = slot.entry.get();
+		if (entry == nullptr)
+		{
+			continue;
+		}
+		if (entry->image.pixels.empty() && entry->page != TextureAtlas::kInvalidPage)
+		{
+			const Image& page = mCachePages[entry->page];
+			const uint32_t x = static_cast<uint32_t>(entry->region.rect.left);
+			const uint32_t y = static_cast<uint32_t>(entry->region.rect.top);
+			entry->image.width = entry->region.width;
+			entry->image.height = entry->region.height;
+			entry->image.pixels.resize(entry->image.width * entry->image.height * 4);
+			for (uint32_t row = 0; row < entry->image.height; ++row)
+			{
+				memcpy(&entry->image.pixels[row * entry->image.width * 4], &page.pixels[((y + row) * page.width + x) * 4], entry->image.width * 4);
+			}
+		}
+		if (!entry->image.pixels.empty())
+		{
+			entries.push_back(entry);
+			images.push_back(&entry->image);
+		}
+	}
+
+	std::vector<TextureAtlas::Placement> placements;
+	std::vector<Image> pages;
+	TextureAtlas::Pack(images, mPageSize, placements, pages);
+
+	for (auto& page : mPages)
+	{
+		ReleaseTexture(page);
+	}
+	mPages.clear();
+	mImagePages.clear();
+	CreatePages(pages);
+
+	std::vector<TextureAtlas::CacheEntry> cacheEntries;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		Entry* entry = entries[i];
+		const TextureAtlas::Placement& placement = placements[i];
+		entry->page = placement.page;
+		if (placement.page == TextureAtlas::kInvalidPage)
+		{
+			// Too big for a page, keep drawing from its own texture
+			entry->region.rect = { 0.0f, 0.0f, 0.0f, 0.0f };
+			if (!mGpu)
+			{
+				entry->region.image = &entry->image;
+				continue;
+			}
+			if (!entry->texture)
+			{
+				entry->texture = std::make_unique<Texture>();
+				entry->texture->Initialize(entry->image.pixels.data(), entry->image.width, entry->image.height);
+			}
+			entry->region.texture = entry->texture.get();
+		}
+		else
+		{
+			ReleaseTexture(entry->texture);
+			SetPage(*entry, placement);
+
+			TextureAtlas::CacheEntry cacheEntry;
+			cacheEntry.name = entry->fileName;
+			cacheEntry.fileSize = entry->fileSize;
+			cacheEntry.fileTime = entry->fileTime;
+			cacheEntry.placement = placement;
+			cacheEntries.push_back(std::move(cacheEntry));
+		}
+		entry->image = Image();
+	}
+
+	if (!mCacheFileName.empty())
+	{
+		TextureAtlas::SaveCache(mCacheFileName.c_str(), cacheEntries, pages);
+	}
+
+	XLOG("[TextureManager] Packed %d textures into %d atlas pages.", static_cast<int>(cacheEntries.size()), static_cast<int>(pages.size()));
+
+	mCacheEntries.clear();
+	mCachePages.clear();
+	mAtlasDirty = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
 TextureId TextureManager::Load(const char* fileName)
 {
+	return Load(fileName, false);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureId TextureManager::LoadAsync(const char* fileName)
+{
+	return Load(fileName, true);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureManager::Update()
+{
+	FinishPending(false);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureManager::IsReady(TextureId id) const
+{
+	const Entry* entry = Find(id);
+	return entry && (entry->region.texture != nullptr || entry->region.image != nullptr);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureManager::IsLoading(TextureId id) const
+{
+	// FinishPending takes the result out of the future once the decode has finished, failed or not
+	const Entry* entry = Find(id);
+	return entry && entry->pending.valid();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureId TextureManager::Load(const char* fileName, bool async)
+{
+	// Fast path, same string as a previous load
+	Probe& probe = mProbes[(reinterpret_cast<uintptr_t>(fileName) >> 3) & (kProbeCount - 1)];
+	if (probe.name == fileName)
+	{
+		const Entry* entry = Find(probe.id);
+		if (entry && entry->name == fileName)
+		{
+			return probe.id;
+		}
+	}
+
+	auto iter = mNames.find(fileName);
+	if (iter != mNames.end())
+	{
+		probe.name = fileName;
+		probe.id = iter->second;
+		return iter->second;
+	}
+
 	std::string fullName = mRoot + "/" + fileName;
 
-	std::hash<std::string> hasher;
-	TextureId hash = hasher(fullName);
+	auto entry = std::make_unique<Entry>();
+	entry->name = fileName;
+	entry->fileName = fullName;
+
+	// Only textures loaded before the atlas is built get packed
+	const bool isDDS = strstr(fileName, ".dds") != nullptr;
+	entry->packable = mPageSize > 0 && !mAtlasBuilt && !isDDS;
 
-	auto result = mInventory.insert({ hash, nullptr });
-	if (result.second)
+	bool cached = false;
+	if (entry->packable && Platform::GetFileStamp(fullName.c_str(), entry->fileSize, entry->fileTime))
 	{
-		Texture* texture = new Texture();
-		if (texture->Initialize(fullName.c_str()))
+		// Reuse the cached placement if the file has not changed since the atlas was built
+		for (const auto& cacheEntry : mCacheEntries)
 		{
-			result.first->second = texture;
+			if (cacheEntry.name == fullName && cacheEntry.fileSize == entry->fileSize && cacheEntry.fileTime == entry->fileTime)
+			{
+				SetPage(*entry, cacheEntry.placement);
+				entry->region.width = cacheEntry.placement.width;
+				entry->region.height = cacheEntry.placement.height;
+				cached = true;
+				break;
+			}
+		}
+	}
+
+	// Not cached, decode it and draw from its own texture until the atlas is built
+	if (!cached)
+	{
+		if (isDDS)
+		{
+			if (!mGpu)
+			{
+				XLOG("[TextureManager] %s: dds textures need a GPU.", fileName);
+				return 0;
+			}
+			entry->texture = std::make_unique<Texture>();
+			if (!entry->texture->Initialize(fullName.c_str()))
+			{
+				ReleaseTexture(entry->texture);
+				return 0;
+			}
+			entry->region.texture = entry->texture.get();
+			entry->region.width = entry->texture->GetWidth();
+			entry->region.height = entry->texture->GetHeight();
+		}
+		else if (async)
+		{
+			// The entry is heap allocated so the worker can write into it while the slot table grows
+			Image* image = &entry->image;
+			entry->pending = ThreadPool::Get()->Submit([image, fullName]() { return DecodeImage(fullName.c_str(), *image); });
 		}
 		else
 		{
-			SafeDelete(texture);
-			mInventory.erase(result.first);
-			hash = 0;
+			if (!DecodeImage(fullName.c_str(), entry->image) || !Upload(*entry))
+			{
+				return 0;
+			}
 		}
 	}
 
-	return hash;
+	const bool pending = entry->pending.valid();
+	const TextureId id = Insert(std::move(entry));
+	if (pending)
+	{
+		mPending.push_back(id);
+	}
+	mNames.emplace(fileName, id);
+	probe.name = fileName;
+	probe.id = id;
+	return id;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureManager::Upload(Entry& entry)
+{
+	if (!mGpu)
+	{
+		// The pixels are what gets drawn, the entry is heap allocated so the pointer is stable
+		entry.region.image = &entry.image;
+		entry.region.width = entry.image.width;
+		entry.region.height = entry.image.height;
+		mAtlasDirty = mAtlasDirty || (entry.packable && !mAtlasBuilt);
+		return true;
+	}
+
+	entry.texture = std::make_unique<Texture>();
+	if (!entry.texture->Initialize(entry.image.pixels.data(), entry.image.width, entry.image.height))
+	{
+		ReleaseTexture(entry.texture);
+		entry.image = Image();
+		return false;
+	}
+
+	entry.region.texture = entry.texture.get();
+	entry.region.width = entry.image.width;
+	entry.region.height = entry.image.height;
+
+	// Pixels are only kept around for packing
+	if (entry.packable && !mAtlasBuilt)
+	{
+		mAtlasDirty = true;
+	}
+	else
+	{
+		entry.packable = false;
+		entry.image = Image();
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureManager::FinishPending(bool wait)
+{
+	auto iter = mPending.begin();
+	while (iter != mPending.end())
+	{
+		Entry* entry = Find(*iter);
+		if (entry && !wait && entry->pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++iter;
+			continue;
+		}
+
+		// Failed loads keep their slot so the handle stays valid, it just never becomes ready
+		if (entry && entry->pending.get())
+		{
+			Upload(*entry);
+		}
+		iter = mPending.erase(iter);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void TextureManager::Clear()
 {
-	for (auto& item : mInventory)
+	// Workers may still be writing into entries
+	FinishPending(true);
+
+	// Bumping the generation makes any handle still held by the game resolve to nothing
+	for (uint32_t index = 1; index < mSlots.size(); ++index)
 	{
-		if (item.second)
+		Slot& slot = mSlots[index];
+		if (slot.entry)
 		{
-			item.second->Terminate();
-			SafeDelete(item.second);
+			ReleaseTexture(slot.entry->texture);
+			slot.entry.reset();
+			slot.generation = (slot.generation + 1) & (0xffffffff >> kIndexBits);
+			mFreeSlots.push_back(index);
 		}
 	}
-	mInventory.clear();
+	mNames.clear();
+	mProbes.fill({});
+
+	for (auto& page : mPages)
+	{
+		ReleaseTexture(page);
+	}
+	mPages.clear();
+	mImagePages.clear();
+	mCacheEntries.clear();
+	mCachePages.clear();
+	mAtlasDirty = false;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void TextureManager::BindVS(TextureId id, uint32_t slot)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	Texture* texture = GetTexture(id);
+	if (texture)
 	{
-		iter->second->BindVS(slot);
+		texture->BindVS(slot);
 	}
 }
 
@@ -119,10 +440,10 @@ void TextureManager::BindVS(TextureId id, uint32_t slot)
 
 void TextureManager::BindPS(TextureId id, uint32_t slot)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	Texture* texture = GetTexture(id);
+	if (texture)
 	{
-		iter->second->BindPS(slot);
+		texture->BindPS(slot);
 	}
 }
 
@@ -130,6 +451,87 @@ void TextureManager::BindPS(TextureId id, uint32_t slot)
 
 Texture* TextureManager::GetTexture(TextureId id)
 {
-	auto iter = mInventory.find(id);
-	return iter != mInventory.end() ? iter->second : nullptr;
-}
\ No newline at end of file
+	const Region* region = GetRegion(id);
+	return region ? region->texture : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const TextureManager::Region* TextureManager::GetRegion(TextureId id) const
+{
+	const Entry* entry = Find(id);
+	return entry ? &entry->region : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureManager::Entry* TextureManager::Find(TextureId id) const
+{
+	const uint32_t index = id & kIndexMask;
+	if (index >= mSlots.size())
+	{
+		return nullptr;
+	}
+	const Slot& slot = mSlots[index];
+	return slot.generation == (id >> kIndexBits) ? slot.entry.get() : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureId TextureManager::Insert(std::unique_ptr<Entry> entry)
+{
+	uint32_t index = 0;
+	if (!mFreeSlots.empty())
+	{
+		index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(mSlots.size());
+		XASSERT(index <= kIndexMask, "[TextureManager] Too many textures loaded.");
+		mSlots.emplace_back();
+	}
+
+	Slot& slot = mSlots[index];
+	slot.entry = std::move(entry);
+	return (slot.generation << kIndexBits) | index;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureManager::CreatePages(const std::vector<Image>& pages)
+{
+	for (auto& page : pages)
+	{
+		if (mGpu)
+		{
+			auto texture = std::make_unique<Texture>();
+			texture->Initialize(page.pixels.data(), page.width, page.height);
+			mPages.push_back(std::move(texture));
+		}
+		else
+		{
+			mImagePages.push_back(std::make_unique<Image>(page));
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureManager::SetPage(Entry& entry, const TextureAtlas::Placement& placement)
+{
+	entry.page = placement.page;
+	if (mGpu)
+	{
+		entry.region.texture = mPages[placement.page].get();
+	}
+	else
+	{
+		entry.region.image = mImagePages[placement.page].get();
+	}
+	entry.region.rect.left = static_cast<float>(placement.x);
+	entry.region.rect.top = static_cast<float>(placement.y);
+	entry.region.rect.right = static_cast<float>(placement.x + placement.width);
+	entry.region.rect.bottom = static_cast<float>(placement.y + placement.height);
+}
@@ -6,6 +6,8 @@
 #ifndef INCLUDED_XENGINE_TEXTUREMANAGER_H
 #define INCLUDED_XENGINE_TEXTUREMANAGER_H
 
+#include "TextureAtlas.h"
+#include "XMath.h"
 #include "XTypes.h"
 
 namespace X {
@@ -13,12 +15,25 @@ namespace X {
 class TextureManager
 {
 public:
-	static void StaticInitialize(const char* root);
+	// Without a GPU (software rendering) pixels are kept in memory instead of being uploaded
+	static void StaticInitialize(const char* root, bool gpu = true);
 	static void StaticTerminate();
 	static TextureManager* Get();
 
+	// Where a loaded texture is drawn from. Packed textures point at their atlas page and sub-rect,
+	// standalone textures use the whole texture and have an empty rect. Only one of texture/image is
+	// set depending on whether the manager uploads to the GPU.
+	struct Region
+	{
+		Texture* texture = nullptr;
+		const Image* image = nullptr;
+		Math::Rect rect{ 0.0f, 0.0f, 0.0f, 0.0f };
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
 public:
-	TextureManager();
+	explicit TextureManager(bool gpu);
 	~TextureManager();
 
 	TextureManager(const TextureManager&) = delete;
@@ -26,17 +41,86 @@ public:
 
 	void SetRootPath(const char* path);
 
+	// Textures loaded before BuildAtlas() are packed into shared pages. The packed result is written to
+	// cacheFileName (if set) and reused on the next run when the source files have not changed.
+	void EnableAtlas(uint32_t pageSize, const char* cacheFileName);
+	void BuildAtlas();
+
 	TextureId Load(const char* fileName);
 	void Clear();
 
+	// Decodes on the thread pool and uploads in Update() on the owning thread. The handle is valid right
+	// away but draws nothing until IsReady() returns true. A load that fails is no longer loading but
+	// never becomes ready.
+	TextureId LoadAsync(const char* fileName);
+	void Update();
+	bool IsReady(TextureId id) const;
+	bool IsLoading(TextureId id) const;
+
 	void BindVS(TextureId id, uint32_t slot = 0);
 	void BindPS(TextureId id, uint32_t slot = 0);
 
 	Texture* GetTexture(TextureId id);
+	const Region* GetRegion(TextureId id) const;
 
 private:
+	static constexpr uint32_t kIndexBits = 20;
+	static constexpr uint32_t kIndexMask = (1 << kIndexBits) - 1;
+	static constexpr uint32_t kProbeCount = 256;
+
+	struct Entry
+	{
+		Region region;
+		std::unique_ptr<Texture> texture;
+		std::string name;
+		std::string fileName;
+		uint64_t fileSize = 0;
+		uint64_t fileTime = 0;
+		uint32_t page = TextureAtlas::kInvalidPage;
+		Image image;
+		std::future<bool> pending;
+		bool packable = false;
+	};
+
+	struct Slot
+	{
+		std::unique_ptr<Entry> entry;
+		uint32_t generation = 0;
+	};
+
+	// Direct mapped on the address of the name passed to Load, so repeated loads with the same string
+	// literal skip hashing
+	struct Probe
+	{
+		const char* name = nullptr;
+		TextureId id = 0;
+	};
+
+	TextureId Load(const char* fileName, bool async);
+	bool Upload(Entry& entry);
+	void FinishPending(bool wait);
+
+	Entry* Find(TextureId id) const;
+	TextureId Insert(std::unique_ptr<Entry> entry);
+	void CreatePages(const std::vector<Image>& pages);
+	void SetPage(Entry& entry, const TextureAtlas::Placement& placement);
+
 	std::string mRoot;
-	std::unordered_map<std::size_t, Texture*> mInventory;
+	std::vector<Slot> mSlots;
+	std::vector<uint32_t> mFreeSlots;
+	std::unordered_map<std::string, TextureId> mNames;
+	std::vector<TextureId> mPending;
+	std::array<Probe, kProbeCount> mProbes;
+
+	std::vector<std::unique_ptr<Texture>> mPages;
+	std::vector<std::unique_ptr<Image>> mImagePages;
+	std::vector<TextureAtlas::CacheEntry> mCacheEntries;
+	std::vector<Image> mCachePages;
+	std::string mCacheFileName;
+	uint32_t mPageSize = 0;
+	bool mAtlasDirty = false;
+	bool mAtlasBuilt = false;
+	bool mGpu = true;
 };
 
 } // namespace Graphics
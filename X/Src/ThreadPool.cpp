@@ -0,0 +1,122 @@
+//====================================================================================================
+// Filename:	ThreadPool.cpp
+// Created by:	Peter Chan
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "ThreadPool.h"
+
+using namespace X;
+
+namespace
+{
+	ThreadPool* sThreadPool = nullptr;
+}
+
+void ThreadPool::StaticInitialize(uint32_t workerCount)
+{
+	XASSERT(sThreadPool == nullptr, "[ThreadPool] Pool already initialized!");
+	sThreadPool = new ThreadPool();
+	sThreadPool->Initialize(workerCount);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ThreadPool::StaticTerminate()
+{
+	if (sThreadPool != nullptr)
+	{
+		sThreadPool->Terminate();
+		SafeDelete(sThreadPool);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ThreadPool* ThreadPool::Get()
+{
+	XASSERT(sThreadPool != nullptr, "[ThreadPool] No instance registered.");
+	return sThreadPool;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ThreadPool::ThreadPool()
+	: mRunning(false)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool()
+{
+	XASSERT(mWorkers.empty(), "[ThreadPool] Terminate() must be called to clean up!");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ThreadPool::Initialize(uint32_t workerCount)
+{
+	XASSERT(!mRunning, "[ThreadPool] Pool already initialized.");
+	mRunning = true;
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		mWorkers.emplace_back(&ThreadPool::Worker, this);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ThreadPool::Terminate()
+{
+	// Workers finish everything already queued before exiting
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+	mCondition.notify_all();
+
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	if (mWorkers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(std::move(job));
+	}
+	mCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ThreadPool::Worker()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this]() { return !mJobs.empty() || !mRunning; });
+			if (mJobs.empty())
+			{
+				return;
+			}
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+		job();
+	}
+}
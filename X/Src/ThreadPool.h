@@ -0,0 +1,54 @@
+//====================================================================================================
+// Filename:	ThreadPool.h
+// Created by:	Peter Chan
+//====================================================================================================
+
+#ifndef INCLUDED_XENGINE_THREADPOOL_H
+#define INCLUDED_XENGINE_THREADPOOL_H
+
+namespace X {
+
+// Fixed set of worker threads pulling from a shared FIFO, used for asset decoding
+class ThreadPool
+{
+public:
+	static void StaticInitialize(uint32_t workerCount);
+	static void StaticTerminate();
+	static ThreadPool* Get();
+
+public:
+	ThreadPool();
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Initialize(uint32_t workerCount);
+	void Terminate();
+
+	// Queues the function and returns a future for its result. With no workers the function runs
+	// immediately on the calling thread.
+	template <class Function>
+	auto Submit(Function&& function) -> std::future<decltype(function())>
+	{
+		using Result = decltype(function());
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+		std::future<Result> future = task->get_future();
+		Enqueue([task]() { (*task)(); });
+		return future;
+	}
+
+private:
+	void Enqueue(std::function<void()> job);
+	void Worker();
+
+	std::vector<std::thread> mWorkers;
+	std::deque<std::function<void()>> mJobs;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mRunning;
+};
+
+} // namespace X
+
+#endif // #ifndef INCLUDED_XENGINE_THREADPOOL_H
@@ -6,38 +6,82 @@
 #include "Precompiled.h"
 #include "Timer.h"
 
+#include "Clock.h"
+#include "XMath.h"
+
 using namespace X;
 
+namespace
+{
+	constexpr float kHitchFactor = 2.0f;
+	constexpr float kHitchMinimum = 4.0f;
+
+	// Bounds for the spin before each frame, in microseconds. The spin follows how late sleeps have been
+	// waking up so it stays short where the scheduler is precise.
+	constexpr uint64_t kMinSpin = 100;
+	constexpr uint64_t kMaxSpin = 4000;
+	constexpr uint64_t kInitialSpin = 1000;
+}
+
 //----------------------------------------------------------------------------------------------------
 
 Timer::Timer()
-	: mElapsedTime(0.0f)
-	, mTotalTime(0.0f)
-	, mLastUpdateTime(0.0f)
+	: mClock(RealClock::Get())
+	, mTicksPerSecond(0)
+	, mLastTick(0)
+	, mCurrentTick(0)
+	, mElapsedTime(0.0f)
+	, mTotalTime(0.0)
+	, mTimeScale(1.0f)
+	, mUnscaledElapsedTime(0.0f)
+	, mUnscaledTotalTime(0.0)
+	, mRealTicksPerSecond(0)
+	, mLastRealTick(0)
+	, mRealTotalTime(0.0)
+	, mFrameTime(0.0f)
+	, mLastUpdateTime(0.0)
 	, mFrameSinceLastSecond(0.0f)
 	, mFramesPerSecond(0.0f)
+	, mHistogram{}
+	, mFrameCount(0)
+	, mHitchCount(0)
+	, mMaxFrameTime(0.0f)
+	, mAverageFrameTime(0.0f)
+	, mTargetFrameRate(0.0f)
+	, mTargetTicks(0)
+	, mNextFrameTick(0)
+	, mSpinTicks(0)
 {
-	mTicksPerSecond.QuadPart = 0;
-	mLastTick.QuadPart = 0;
-	mCurrentTick.QuadPart = 0;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void Timer::Initialize()
 {
-	// Get the system clock frequency and current tick
-	QueryPerformanceFrequency(&mTicksPerSecond);
-	QueryPerformanceCounter(&mCurrentTick);
+	// Get the clock frequency and current tick
+	mTicksPerSecond = mClock->GetFrequency();
+	mCurrentTick = mClock->GetTicks();
 
 	mLastTick = mCurrentTick;
 	
 	// Reset
 	mElapsedTime = 0.0f;
-	mTotalTime = 0.0f;
-	mLastUpdateTime = 0.0f;
+	mTotalTime = 0.0;
+	mUnscaledElapsedTime = 0.0f;
+	mUnscaledTotalTime = 0.0;
+	mLastUpdateTime = 0.0;
 	mFrameSinceLastSecond = 0.0f;
 	mFramesPerSecond = 0.0f;
+
+	// The stats and the limiter work off the real clock
+	mRealTicksPerSecond = Platform::GetClockFrequency();
+	mLastRealTick = Platform::GetClockTicks();
+	mRealTotalTime = 0.0;
+	mFrameTime = 0.0f;
+	mNextFrameTick = mLastRealTick;
+	mSpinTicks = mRealTicksPerSecond * kInitialSpin / 1000000;
+	SetTargetFrameRate(mTargetFrameRate);
+	ResetFrameTimeStats();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -45,22 +89,132 @@ void Timer::Initialize()
 void Timer::Update()
 {
 	// Get the current tick count
-	QueryPerformanceCounter(&mCurrentTick);
+	mCurrentTick = mClock->GetTicks();
 
 	// Calculate the total time and elapsed time
-	mElapsedTime = static_cast<float>(mCurrentTick.QuadPart - mLastTick.QuadPart) / mTicksPerSecond.QuadPart;
+	mUnscaledElapsedTime = static_cast<float>(mCurrentTick - mLastTick) / mTicksPerSecond;
+	mUnscaledTotalTime += mUnscaledElapsedTime;
+	mElapsedTime = mUnscaledElapsedTime * mTimeScale;
 	mTotalTime += mElapsedTime;
 
 	// Update the last tick count
 	mLastTick = mCurrentTick;
 
+	// How long the frame really took, a manual clock only says how far the game moved
+	const uint64_t realTick = Platform::GetClockTicks();
+	const float realElapsedTime = static_cast<float>(realTick - mLastRealTick) / mRealTicksPerSecond;
+	mRealTotalTime += realElapsedTime;
+	mLastRealTick = realTick;
+
 	// Calculate the FPS
 	mFrameSinceLastSecond += 1.0f;
-	if (mTotalTime >= mLastUpdateTime + 1.0f)
+	if (mRealTotalTime >= mLastUpdateTime + 1.0)
 	{
-		mFramesPerSecond = mFrameSinceLastSecond / (mTotalTime - mLastUpdateTime);
+		mFramesPerSecond = static_cast<float>(mFrameSinceLastSecond / (mRealTotalTime - mLastUpdateTime));
 		mFrameSinceLastSecond = 0.0f;
-		mLastUpdateTime = mTotalTime;
+		mLastUpdateTime = mRealTotalTime;
+	}
+
+	// Record the frame time
+	const float frameTime = realElapsedTime * 1000.0f;
+	mFrameTime = frameTime;
+	const uint32_t bin = Math::Min(static_cast<uint32_t>(frameTime / kHistogramBinSize), kHistogramBins - 1);
+	mHistogram[bin]++;
+	mMaxFrameTime = Math::Max(mMaxFrameTime, frameTime);
+	if (mFrameCount > 0 && frameTime > mAverageFrameTime * kHitchFactor && frameTime > mAverageFrameTime + kHitchMinimum)
+	{
+		++mHitchCount;
+	}
+	mAverageFrameTime = mFrameCount > 0 ? mAverageFrameTime + (frameTime - mAverageFrameTime) * 0.1f : frameTime;
+	++mFrameCount;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Timer::SetClock(Clock* clock)
+{
+	mClock = clock ? clock : RealClock::Get();
+
+	// Carry on from the new clock's current time, the next frame starts counting from here
+	mTicksPerSecond = mClock->GetFrequency();
+	mCurrentTick = mClock->GetTicks();
+	mLastTick = mCurrentTick;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Timer::SetTimeScale(float scale)
+{
+	XASSERT(scale >= 0.0f, "[Timer] Time scale cannot be negative.");
+	mTimeScale = scale;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetTimeScale() const
+{
+	return mTimeScale;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Timer::SetTargetFrameRate(float framesPerSecond)
+{
+	mTargetFrameRate = Math::Max(framesPerSecond, 0.0f);
+	mTargetTicks = mTargetFrameRate > 0.0f ? static_cast<uint64_t>(mRealTicksPerSecond / mTargetFrameRate) : 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetTargetFrameRate() const
+{
+	return mTargetFrameRate;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Timer::WaitForNextFrame()
+{
+	if (mTargetTicks == 0)
+	{
+		return;
+	}
+
+	// Deadlines advance by exactly one frame so the rate doesn't drift with wake up latency. If we have
+	// fallen more than a frame behind, start over from now rather than rushing to catch up.
+	uint64_t now = Platform::GetClockTicks();
+	mNextFrameTick += mTargetTicks;
+	if (now >= mNextFrameTick)
+	{
+		if (now - mNextFrameTick > mTargetTicks)
+		{
+			mNextFrameTick = now;
+		}
+		return;
+	}
+
+	const uint64_t minSpin = mRealTicksPerSecond * kMinSpin / 1000000;
+	const uint64_t maxSpin = mRealTicksPerSecond * kMaxSpin / 1000000;
+	while (mNextFrameTick - now > mSpinTicks)
+	{
+		const uint64_t request = mNextFrameTick - now - mSpinTicks;
+		std::this_thread::sleep_for(std::chrono::nanoseconds(request * 1000000000 / mRealTicksPerSecond));
+
+		// Keep the spin at twice the worst recent overshoot, decaying slowly towards the minimum
+		const uint64_t woke = Platform::GetClockTicks();
+		const uint64_t overshoot = woke - now > request ? woke - now - request : 0;
+		mSpinTicks = Math::Max(mSpinTicks - (mSpinTicks >> 4), overshoot * 2);
+		mSpinTicks = Math::Clamp(mSpinTicks, minSpin, maxSpin);
+		now = woke;
+		if (now >= mNextFrameTick)
+		{
+			return;
+		}
+	}
+
+	while (Platform::GetClockTicks() < mNextFrameTick)
+	{
+		std::this_thread::yield();
 	}
 }
 
@@ -75,7 +229,14 @@ float Timer::GetElapsedTime() const
 
 float Timer::GetTotalTime() const
 {
-	return mTotalTime;
+	return static_cast<float>(mTotalTime);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetUnscaledElapsedTime() const
+{
+	return mUnscaledElapsedTime;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -83,4 +244,66 @@ float Timer::GetTotalTime() const
 float Timer::GetFramesPerSecond() const
 {
 	return mFramesPerSecond;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetFrameTime() const
+{
+	return mFrameTime;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetFrameTimePercentile(float percent) const
+{
+	if (mFrameCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// Walk the bins until enough frames are covered, report the upper edge of that bin
+	const uint32_t rank = Math::Min(mFrameCount - 1, static_cast<uint32_t>(mFrameCount * Math::Clamp(percent, 0.0f, 1.0f)));
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < kHistogramBins; ++i)
+	{
+		count += mHistogram[i];
+		if (count > rank)
+		{
+			return Math::Min((i + 1) * kHistogramBinSize, mMaxFrameTime);
+		}
+	}
+	return mMaxFrameTime;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Timer::GetMaxFrameTime() const
+{
+	return mMaxFrameTime;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t Timer::GetFrameCount() const
+{
+	return mFrameCount;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t Timer::GetHitchCount() const
+{
+	return mHitchCount;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Timer::ResetFrameTimeStats()
+{
+	mHistogram.fill(0);
+	mFrameCount = 0;
+	mHitchCount = 0;
+	mMaxFrameTime = 0.0f;
+	mAverageFrameTime = 0.0f;
 }
\ No newline at end of file
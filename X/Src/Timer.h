@@ -8,30 +8,83 @@
 
 namespace X {
 
+class Clock;
+
 class Timer
 {
 public:
+	// Frame times are binned at 0.1 ms up to 100 ms, anything slower lands in the last bin
+	static constexpr uint32_t kHistogramBins = 1000;
+	static constexpr float kHistogramBinSize = 0.1f;
+
 	Timer();
 
 	void Initialize();
 	void Update();
 
+	// Time source for Update, nullptr goes back to the real clock. The frame limiter, frame rate and
+	// frame time stats always use real time whatever the clock.
+	void SetClock(Clock* clock);
+
+	// Scales the elapsed and total times handed to the game, frame time stats stay unscaled
+	void SetTimeScale(float scale);
+	float GetTimeScale() const;
+
+	// Blocks until the target frame time has passed since the previous frame. Sleeps for most of the
+	// wait and spins through the last stretch, where sleeping would overshoot. A rate of 0 disables it.
+	void SetTargetFrameRate(float framesPerSecond);
+	float GetTargetFrameRate() const;
+	void WaitForNextFrame();
+
 	float GetElapsedTime() const;
 	float GetTotalTime() const;
+	float GetUnscaledElapsedTime() const;
 	float GetFramesPerSecond() const;
 
+	// Real time the last frame took in milliseconds
+	float GetFrameTime() const;
+
+	// Frame time distribution in milliseconds since Initialize or ResetFrameTimeStats. A hitch is a frame
+	// taking over twice the moving average and at least 4 ms longer than it.
+	float GetFrameTimePercentile(float percent) const;
+	float GetMaxFrameTime() const;
+	uint32_t GetFrameCount() const;
+	uint32_t GetHitchCount() const;
+	void ResetFrameTimeStats();
+
 private:
-	// http://msdn2.microsoft.com/en-us/library/aa383713.aspx
-	LARGE_INTEGER mTicksPerSecond;
-	LARGE_INTEGER mLastTick;
-	LARGE_INTEGER mCurrentTick;
+	Clock* mClock;
+	uint64_t mTicksPerSecond;
+	uint64_t mLastTick;
+	uint64_t mCurrentTick;
 	
+	// Totals are kept in double so long or fast forwarded sessions don't lose precision
 	float mElapsedTime;
-	float mTotalTime;
+	double mTotalTime;
+	float mTimeScale;
+	float mUnscaledElapsedTime;
+	double mUnscaledTotalTime;
 	
-	float mLastUpdateTime;
+	// Real time, for the stats
+	uint64_t mRealTicksPerSecond;
+	uint64_t mLastRealTick;
+	double mRealTotalTime;
+	float mFrameTime;
+
+	double mLastUpdateTime;
 	float mFrameSinceLastSecond;
 	float mFramesPerSecond;
+
+	std::array<uint32_t, kHistogramBins> mHistogram;
+	uint32_t mFrameCount;
+	uint32_t mHitchCount;
+	float mMaxFrameTime;
+	float mAverageFrameTime;
+
+	float mTargetFrameRate;
+	uint64_t mTargetTicks;
+	uint64_t mNextFrameTick;
+	uint64_t mSpinTicks;
 };
 
 } // namespace X
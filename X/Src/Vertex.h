@@ -46,6 +46,16 @@ struct VertexPC
 
 //----------------------------------------------------------------------------------------------------
 
+// Color packed as RGBA8, see PackColor
+struct VertexPC32
+{
+	static const uint32_t Format;
+	Math::Vector3 position;
+	uint32_t color;
+};
+
+//----------------------------------------------------------------------------------------------------
+
 struct VertexPNX
 {
 	static const uint32_t Format;
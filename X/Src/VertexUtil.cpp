@@ -79,6 +79,19 @@ std::vector<D3D11_INPUT_ELEMENT_DESC> VertexUtil::CreateVertexLayout(uint32_t ve
 		desc.InstanceDataStepRate = 0;
 		offset += GetElementSize(VE_Color);
 	}
+	if (HasElement(vertexFormat, VE_Color32))
+	{
+		layout.push_back(D3D11_INPUT_ELEMENT_DESC());
+		D3D11_INPUT_ELEMENT_DESC& desc = layout.back();
+		desc.SemanticName = "COLOR";
+		desc.SemanticIndex = 0;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.InputSlot = 0;
+		desc.AlignedByteOffset = offset;
+		desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+		desc.InstanceDataStepRate = 0;
+		offset += GetElementSize(VE_Color32);
+	}
 	if (HasElement(vertexFormat, VE_BIndices))
 	{
 		layout.push_back(D3D11_INPUT_ELEMENT_DESC());
@@ -6,88 +6,281 @@
 #include "Precompiled.h"
 #include "XEngine.h"
 
-#include "AudioSystem.h"
 #include "Config.h"
 #include "Camera.h"
+#include "Clock.h"
+#include "Fence.h"
 #include "Font.h"
-#include "GraphicsSystem.h"
-#include "Gui.h"
+#include "FrameAllocator.h"
 #include "InputSystem.h"
+#include "JobSystem.h"
+#include "PerfHud.h"
+#include "Platform.h"
+#include "PngCodec.h"
+#include "RadixSort.h"
 #include "SimpleDraw.h"
-#include "SoundEffectManager.h"
-#include "SpriteRenderer.h"
-#include "Texture.h"
+#include "SoftwareRenderer.h"
+#include "StatsRecorder.h"
 #include "TextureManager.h"
+#include "ThreadPool.h"
 #include "Timer.h"
 
-#pragma comment(lib, "FW1FontWrapper.lib")
+// D3D11 rendering and XAudio2 sound are only available on Windows, other platforms always render in
+// software and play no sound
+#if defined(_WIN32)
+#include "AudioSystem.h"
+#include "GraphicsSystem.h"
+#include "Gui.h"
+#include "SoundEffectManager.h"
+#include "SpriteRenderer.h"
+#include "Texture.h"
+#endif
 
 using namespace X;
 
 namespace
 {
+	// 24 bytes. Source rects are rare so they live in a side list, rect is 1 + the index into it and
+	// 0 draws the whole texture.
 	struct SpriteCommand
 	{
-		SpriteCommand(TextureId inTextureId, const Math::Vector2& inPosiiton, float inRotation)
-			: textureId(inTextureId)
-			, sourceRect({ 0.0f, 0.0f, 0.0f, 0.0f })
-			, position(inPosiiton)
-			, rotation(inRotation)
-		{}
-
-		SpriteCommand(TextureId inTextureId, const Math::Vector2& inPosiiton, float inRotation, Pivot pivot, Flip flip)
-			: textureId(inTextureId)
-			, sourceRect({ 0.0f, 0.0f, 0.0f, 0.0f })
-			, position(inPosiiton)
-			, rotation(inRotation)
-			, pivot(pivot)
-			, flip(flip)
-		{}
-
-		SpriteCommand(TextureId inTextureId, const Math::Rect& inSourceRect, const Math::Vector2& inPosiiton, float inRotation)
-			: textureId(inTextureId)
-			, sourceRect(inSourceRect)
-			, position(inPosiiton)
-			, rotation(inRotation)
-		{}
+		TextureId textureId;
+		uint32_t rect;
+		Math::Vector2 position;
+		float rotation;
+		uint8_t pivot;
+		uint8_t flip;
+	};
 
-		TextureId textureId = 0;
-		Math::Rect sourceRect{};
-		Math::Vector2 position{ 0.0f };
-		float rotation{ 0.0f };
-		Pivot pivot = Pivot::Center;
-		Flip flip = Flip::None;
+	// A sprite resolved against its texture region on the game thread. The source is the region's
+	// Image or Texture, so drawing it never goes back to the texture manager.
+	struct SpriteDraw
+	{
+		const void* source;
+		Math::Rect sourceRect;
+		Math::Vector2 position;
+		float rotation;
+		uint8_t pivot;
+		uint8_t flip;
 	};
 
+	// The string is a range of the frame's text bytes, kept as UTF-8 until the backend draws it
 	struct TextCommand
 	{
-		TextCommand(std::wstring inStr, float inSize, float inX, float inY, uint32_t inColor)
-			: str(std::move(inStr))
-			, size(inSize)
-			, x(inX)
-			, y(inY)
-			, color(inColor)
-		{}
-
-		std::wstring str;
+		uint32_t offset, length;
 		float size, x, y;
 		uint32_t color;
 	};
+
+	// Decoded and laid out text of the command in the same slot last frame. A label that did not
+	// change is not decoded or laid out again, and the buffers keep their capacity so steady state text
+	// does not allocate.
+	struct TextRun
+	{
+		std::string utf8;
+		std::wstring str;
+		float size = 0.0f;
+		std::vector<GlyphQuad> quads;
+	};
 	
-	HWND myWindow = nullptr;
 	bool initialized = false;
+	bool mySoftwareRendering = false;
 
-	std::random_device myRandomDevice{};
-	std::mt19937 myRandomEngine{ myRandomDevice() };
+	uint64_t myRandomSeed = 0;
+	std::atomic<uint32_t> myRandomGeneration{ 1 };
+	std::atomic<uint32_t> myRandomStreamCount{ 0 };
 
 	Color myBackgroundColor = { 0.1f, 0.1f, 0.1f, 1.0f };
 	Camera myCamera;
 	Font myFont;
+#if defined(_WIN32)
+	Texture myFontTexture;
+#endif
 	Timer myTimer;
+	ManualClock myManualClock;
+	float myFixedTimeStep = 0.0f;
 	float myZoom = 1.0f;
 
-	std::vector<SpriteCommand> mySpriteCommands;
-	std::vector<TextCommand> myTextCommands;
+	// Everything the game records for one frame, in memory from the frame allocator, plus the view
+	// state captured when the frame is submitted. Rendering reads nothing else the game can change.
+	struct FrameCommands
+	{
+		explicit FrameCommands(FrameAllocator& allocator)
+			: sprites(allocator)
+			, spriteKeys(allocator)
+			, spriteRects(allocator)
+			, draws(allocator)
+			, text(allocator)
+			, textBytes(allocator)
+		{}
+
+		void Clear()
+		{
+			sprites.clear();
+			spriteKeys.clear();
+			spriteRects.clear();
+			draws.clear();
+			text.clear();
+			textBytes.clear();
+			captureName.clear();
+		}
+
+		FrameVector<SpriteCommand> sprites;
+		FrameVector<uint64_t> spriteKeys;
+		FrameVector<Math::Rect> spriteRects;
+		FrameVector<SpriteDraw> draws;
+		FrameVector<TextCommand> text;
+		FrameVector<char> textBytes;
+
+		Camera camera;
+		Color backgroundColor;
+		Math::Matrix4 transform;
+		std::string captureName;
+		float renderTime = 0.0f;
+	};
+
+	constexpr size_t kFrameArenaSize = 256 * 1024;
+
+	// Frame n is recorded into myFrames[n & 1], counting from 1
+	FrameAllocator myFrameAllocator;
+	FrameCommands myFrames[2]{ FrameCommands(myFrameAllocator), FrameCommands(myFrameAllocator) };
+	FrameCommands* myCommands = &myFrames[1];
+	uint32_t mySubmitCount = 0;
+	uint8_t mySpriteLayer = 0;
+	std::vector<TextRun> myTextRuns;
+
+	// With threaded rendering the render thread draws frame n once mySubmitted reaches n, then raises
+	// myRendered to n. The game thread reuses a frame's memory only after it has been rendered.
+	bool myThreadedRendering = false;
+	std::thread myRenderThread;
+	std::atomic<uint32_t> myRenderStopFrame{ 0 };
+	Fence mySubmitted;
+	Fence myRendered;
+
+	// Sprites drawn from threads other than the game thread, or from the game thread while it runs a
+	// job. Each thread registers a buffer the first time it draws and the game thread merges them all
+	// into the frame after the game loop returns.
+	struct ThreadSprite
+	{
+		SpriteCommand command;
+		Math::Rect rect;
+		uint8_t layer;
+	};
+
+	struct ThreadSpriteBuffer
+	{
+		std::vector<ThreadSprite> sprites;
+
+		// Set inside a job, the layer only holds for that job. Jobs land on threads by scheduling, a
+		// layer left over from another job would differ between runs.
+		uint8_t layer = 0;
+		uint32_t layerJob = 0;
+	};
+
+	thread_local bool myIsGameThread = false;
+	std::mutex mySpriteBufferMutex;
+	std::vector<std::unique_ptr<ThreadSpriteBuffer>> mySpriteBuffers;
+	std::vector<ThreadSprite> myThreadSprites;
+	std::atomic<uint32_t> mySpriteBufferGeneration{ 1 };
+
+	FrameStats myFrameStats;
+
+	using SteadyClock = std::chrono::steady_clock;
+
+	inline float ToMilliseconds(SteadyClock::duration duration)
+	{
+		return std::chrono::duration<float, std::milli>(duration).count();
+	}
+
+	// Sprites are submitted sorted by (layer, texture, order) so each texture is bound once per layer
+	// while call order is kept within the same texture. The texture bits are the handle's slot index.
+	inline uint64_t MakeSpriteKey(uint8_t layer, TextureId textureId, uint32_t order)
+	{
+		return (static_cast<uint64_t>(layer) << 56) | (static_cast<uint64_t>(textureId & 0xffffff) << 32) | order;
+	}
+
+	inline void AddSprite(TextureId textureId, uint32_t rect, const Math::Vector2& position, float rotation, Pivot pivot, Flip flip)
+	{
+		const uint32_t order = static_cast<uint32_t>(myCommands->sprites.size());
+		myCommands->sprites.emplace_back(textureId, rect, position, rotation, static_cast<uint8_t>(pivot), static_cast<uint8_t>(flip));
+		myCommands->spriteKeys.push_back(MakeSpriteKey(mySpriteLayer, textureId, order));
+	}
+
+	// The buffer lives until the engine stops, a thread that draws again after a restart gets a new one
+	ThreadSpriteBuffer& GetThreadSpriteBuffer()
+	{
+		thread_local ThreadSpriteBuffer* buffer = nullptr;
+		thread_local uint32_t generation = 0;
+		const uint32_t current = mySpriteBufferGeneration.load(std::memory_order_acquire);
+		if (generation != current)
+		{
+			std::lock_guard<std::mutex> lock(mySpriteBufferMutex);
+			buffer = mySpriteBuffers.emplace_back(std::make_unique<ThreadSpriteBuffer>()).get();
+			generation = current;
+		}
+		return *buffer;
+	}
+
+	void AddThreadSprite(TextureId textureId, const Math::Rect* rect, const Math::Vector2& position, float rotation, Pivot pivot, Flip flip)
+	{
+		ThreadSpriteBuffer& buffer = GetThreadSpriteBuffer();
+		ThreadSprite& sprite = buffer.sprites.emplace_back();
+		sprite.command = { textureId, rect ? 1u : 0u, position, rotation, static_cast<uint8_t>(pivot), static_cast<uint8_t>(flip) };
+		sprite.rect = rect ? *rect : Math::Rect{ 0.0f, 0.0f, 0.0f, 0.0f };
+		sprite.layer = buffer.layerJob == JobSystem::GetCurrentJob() ? buffer.layer : 0;
+	}
+
+	// The game thread records straight into the frame in call order, except inside a job. Which job
+	// slices it runs depends on scheduling, so those go through its buffer like any other thread's.
+	inline bool DrawsDirectly()
+	{
+		return myIsGameThread && JobSystem::GetCurrentJob() == 0;
+	}
+
+	// Which thread drew a sprite depends on scheduling, so thread sprites are ordered by what they
+	// draw instead. Two sprites that compare equal draw the same pixels in either order.
+	bool SortsBefore(const ThreadSprite& a, const ThreadSprite& b)
+	{
+		const SpriteCommand& ca = a.command;
+		const SpriteCommand& cb = b.command;
+		return std::tie(a.layer, ca.textureId, ca.position.y, ca.position.x, ca.rotation, ca.pivot, ca.flip, ca.rect, a.rect.left, a.rect.top, a.rect.right, a.rect.bottom)
+			< std::tie(b.layer, cb.textureId, cb.position.y, cb.position.x, cb.rotation, cb.pivot, cb.flip, cb.rect, b.rect.left, b.rect.top, b.rect.right, b.rect.bottom);
+	}
+
+	// Game thread, appends every buffered sprite to the frame after the ones drawn directly. Other
+	// threads must be done drawing for the frame by the time the game loop returns.
+	void MergeThreadSprites(FrameCommands& frame)
+	{
+		myThreadSprites.clear();
+		{
+			std::lock_guard<std::mutex> lock(mySpriteBufferMutex);
+			for (auto& buffer : mySpriteBuffers)
+			{
+				myThreadSprites.insert(myThreadSprites.end(), buffer->sprites.begin(), buffer->sprites.end());
+				buffer->sprites.clear();
+				buffer->layer = 0;
+				buffer->layerJob = 0;
+			}
+		}
+		if (myThreadSprites.empty())
+		{
+			return;
+		}
+
+		std::sort(myThreadSprites.begin(), myThreadSprites.end(), SortsBefore);
+		for (const ThreadSprite& sprite : myThreadSprites)
+		{
+			SpriteCommand command = sprite.command;
+			if (command.rect > 0)
+			{
+				frame.spriteRects.push_back(sprite.rect);
+				command.rect = static_cast<uint32_t>(frame.spriteRects.size());
+			}
+			const uint32_t order = static_cast<uint32_t>(frame.sprites.size());
+			frame.sprites.push_back(command);
+			frame.spriteKeys.push_back(MakeSpriteKey(sprite.layer, command.textureId, order));
+		}
+	}
 
 	inline uint32_t ToColor(const Color& color)
 	{
@@ -96,33 +289,261 @@ namespace
 		uint8_t b = (uint8_t)(color.b * 255);
 		return 0xff000000 | (b << 16) | (g << 8) | r;
 	}
-}
 
-LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
-{
-	switch (msg)
+	// Invalid or truncated sequences decode to U+FFFD, code points above the BMP become surrogate
+	// pairs where wchar_t is 16 bits. Invalid covers stray continuation bytes, leads 0xf8 and up,
+	// overlong forms, surrogates and anything past U+10FFFF.
+	void DecodeUtf8(const char* bytes, size_t length, std::wstring& str)
+	{
+		str.clear();
+		const uint8_t* c = reinterpret_cast<const uint8_t*>(bytes);
+		const uint8_t* end = c + length;
+		while (c < end)
+		{
+			uint32_t codePoint = *c++;
+			int continuation = 0;
+			uint32_t minimum = 0;
+			if (codePoint < 0x80)							{ }
+			else if (codePoint < 0xc2)						{ codePoint = 0xfffd; }
+			else if (codePoint < 0xe0)						{ codePoint &= 0x1f; continuation = 1; minimum = 0x80; }
+			else if (codePoint < 0xf0)						{ codePoint &= 0x0f; continuation = 2; minimum = 0x800; }
+			else if (codePoint < 0xf8)						{ codePoint &= 0x07; continuation = 3; minimum = 0x10000; }
+			else											{ codePoint = 0xfffd; }
+			for (; continuation > 0; --continuation)
+			{
+				if (c == end || (*c & 0xc0) != 0x80)
+				{
+					codePoint = 0xfffd;
+					break;
+				}
+				codePoint = (codePoint << 6) | (*c++ & 0x3f);
+			}
+			if (codePoint < minimum || (codePoint >= 0xd800 && codePoint <= 0xdfff) || codePoint > 0x10ffff)
+			{
+				codePoint = 0xfffd;
+			}
+
+			if (codePoint > 0xffff && sizeof(wchar_t) == 2)
+			{
+				codePoint -= 0x10000;
+				str.push_back(static_cast<wchar_t>(0xd800 + (codePoint >> 10)));
+				str.push_back(static_cast<wchar_t>(0xdc00 + (codePoint & 0x3ff)));
+			}
+			else
+			{
+				str.push_back(static_cast<wchar_t>(codePoint));
+			}
+		}
+	}
+
+	// Each thread gets the next stream of the session seed the first time it asks after a reseed
+	RandomStream& GetThreadRandomStream()
 	{
-	case WM_SIZE:
-		// TODO: Resize logic
-		//if (g_pd3dDevice != NULL && wParam != SIZE_MINIMIZED)
-		//{
-		//	ImGui_ImplDX11_InvalidateDeviceObjects();
-		//	CleanupRenderTarget();
-		//	g_pSwapChain->ResizeBuffers(0, (UINT)LOWORD(lParam), (UINT)HIWORD(lParam), DXGI_FORMAT_UNKNOWN, 0);
-		//	CreateRenderTarget();
-		//	ImGui_ImplDX11_CreateDeviceObjects();
-		//}
-		return 0;
-	case WM_SYSCOMMAND:
-		if ((wParam & 0xfff0) == SC_KEYMENU) // Disable ALT application menu
-			return 0;
-		break;
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		return 0;
+		thread_local RandomStream stream;
+		thread_local uint32_t generation = 0;
+		const uint32_t current = myRandomGeneration.load(std::memory_order_acquire);
+		if (generation != current)
+		{
+			stream.Seed(myRandomSeed, myRandomStreamCount.fetch_add(1));
+			generation = current;
+		}
+		return stream;
 	}
 
-	return DefWindowProcA(hWnd, msg, wParam, lParam);
+	// Game thread, sorts the recorded sprites and resolves them against their texture regions
+	void SubmitFrame(FrameCommands& frame, FrameStats& stats)
+	{
+		FrameVector<uint64_t>& spriteKeys = frame.spriteKeys;
+		RadixSort(spriteKeys.data(), myFrameAllocator.Allocate<uint64_t>(spriteKeys.size()), spriteKeys.size());
+
+		TextureId id = 0;
+		const TextureManager::Region* region = nullptr;
+		const void* source = nullptr;
+		const void* page = nullptr;
+		for (const uint64_t key : spriteKeys)
+		{
+			const SpriteCommand& command = frame.sprites[static_cast<uint32_t>(key)];
+			if (id != command.textureId)
+			{
+				region = TextureManager::Get()->GetRegion(command.textureId);
+				id = command.textureId;
+				source = region ? (mySoftwareRendering ? static_cast<const void*>(region->image) : region->texture) : nullptr;
+				if (source == nullptr)
+				{
+					// Still loading
+					region = nullptr;
+				}
+				else if (source != page)
+				{
+					page = source;
+					++stats.textureChanges;
+				}
+			}
+			if (region)
+			{
+				// Source rects are relative to the original texture, move them into the atlas page
+				const bool packed = !Math::IsEmpty(region->rect);
+				Math::Rect sourceRect = command.rect > 0 ? frame.spriteRects[command.rect - 1] : Math::Rect{ 0.0f, 0.0f, 0.0f, 0.0f };
+				if (Math::IsEmpty(sourceRect))
+				{
+					sourceRect = packed ? region->rect : Math::Rect{ 0.0f, 0.0f, static_cast<float>(region->width), static_cast<float>(region->height) };
+				}
+				else if (packed)
+				{
+					sourceRect.left += region->rect.left;
+					sourceRect.top += region->rect.top;
+					sourceRect.right += region->rect.left;
+					sourceRect.bottom += region->rect.top;
+				}
+				frame.draws.emplace_back(source, sourceRect, command.position, command.rotation, command.pivot, command.flip);
+			}
+		}
+
+		frame.camera = myCamera;
+		frame.backgroundColor = myBackgroundColor;
+		frame.transform = Math::Matrix4::Scaling(myZoom);
+	}
+
+	// Draws a submitted frame, on the render thread when rendering is threaded
+	void RenderFrame(FrameCommands& frame)
+	{
+		const SteadyClock::time_point renderStart = SteadyClock::now();
+
+		// Begin scene
+		SoftwareRenderer* softwareRenderer = mySoftwareRendering ? SoftwareRenderer::Get() : nullptr;
+		if (softwareRenderer)
+		{
+			softwareRenderer->SetTransform(frame.transform);
+			softwareRenderer->BeginRender(frame.backgroundColor);
+		}
+#if defined(_WIN32)
+		else
+		{
+			GraphicsSystem::Get()->BeginRender(frame.backgroundColor);
+			SpriteRenderer::Get()->SetTransform(frame.transform);
+			SpriteRenderer::Get()->BeginRender();
+		}
+#endif
+
+		// Sprites
+		for (const SpriteDraw& draw : frame.draws)
+		{
+			const Pivot pivot = static_cast<Pivot>(draw.pivot);
+			const Flip flip = static_cast<Flip>(draw.flip);
+			if (softwareRenderer)
+			{
+				softwareRenderer->Draw(*static_cast<const Image*>(draw.source), draw.sourceRect, draw.position, draw.rotation, pivot, flip);
+			}
+#if defined(_WIN32)
+			else
+			{
+				SpriteRenderer::Get()->Draw(*static_cast<const Texture*>(draw.source), draw.sourceRect, draw.position, draw.rotation, pivot, flip);
+			}
+#endif
+		}
+#if defined(_WIN32)
+		if (!softwareRenderer)
+		{
+			SpriteRenderer::Get()->EndRender();
+		}
+#endif
+
+		// Text, glyph quads from the font atlas in screen space
+		const FrameVector<TextCommand>& textCommands = frame.text;
+		if (myTextRuns.size() < textCommands.size())
+		{
+			myTextRuns.resize(textCommands.size());
+		}
+#if defined(_WIN32)
+		if (!softwareRenderer && !textCommands.empty())
+		{
+			SpriteRenderer::Get()->SetTransform(Math::Matrix4::Identity());
+			SpriteRenderer::Get()->BeginRender();
+		}
+#endif
+		for (size_t i = 0; i < textCommands.size(); ++i)
+		{
+			const TextCommand& command = textCommands[i];
+			const char* utf8 = frame.textBytes.data() + command.offset;
+			TextRun& run = myTextRuns[i];
+			if (run.utf8.size() != command.length || memcmp(run.utf8.data(), utf8, command.length) != 0 || run.size != command.size)
+			{
+				run.utf8.assign(utf8, command.length);
+				run.size = command.size;
+				DecodeUtf8(utf8, command.length, run.str);
+				myFont.Layout(run.str.c_str(), run.size, run.quads);
+			}
+
+			const Math::Vector2 position(command.x, command.y);
+			const uint32_t quadCount = static_cast<uint32_t>(run.quads.size());
+			if (softwareRenderer)
+			{
+				softwareRenderer->DrawGlyphs(myFont.GetAtlas(), run.quads.data(), quadCount, position, command.color);
+			}
+#if defined(_WIN32)
+			else
+			{
+				SpriteRenderer::Get()->DrawGlyphs(myFontTexture, run.quads.data(), quadCount, position, command.color);
+			}
+#endif
+		}
+#if defined(_WIN32)
+		if (!softwareRenderer && !textCommands.empty())
+		{
+			SpriteRenderer::Get()->EndRender();
+		}
+#endif
+
+		// Lines from the last SimpleDraw::Flip
+		SimpleDraw::Render(frame.camera);
+
+		if (softwareRenderer)
+		{
+			if (!frame.captureName.empty())
+			{
+				SavePng(frame.captureName.c_str(), softwareRenderer->GetFrameBuffer());
+			}
+			Platform::PresentFrame(softwareRenderer->GetFrameBuffer());
+		}
+#if defined(_WIN32)
+		else
+		{
+			// Overlay
+			PerfHud::Render();
+
+			// End Gui
+			Gui::EndRender();
+
+			// End scene
+			GraphicsSystem::Get()->EndRender();
+		}
+#endif
+
+		frame.renderTime = ToMilliseconds(SteadyClock::now() - renderStart);
+	}
+
+	void RenderThread(uint32_t firstFrame)
+	{
+		for (uint32_t frame = firstFrame;; ++frame)
+		{
+			mySubmitted.Wait(frame);
+			if (frame == myRenderStopFrame.load())
+			{
+				break;
+			}
+			RenderFrame(myFrames[frame & 1]);
+			myRendered.Signal(frame);
+		}
+	}
+
+	// Blocks until every submitted frame has been drawn, for changes to what frames point at
+	void WaitForRenderThread()
+	{
+		if (myThreadedRendering)
+		{
+			myRendered.Wait(mySubmitCount);
+		}
+	}
 }
 
 namespace X {
@@ -131,87 +552,96 @@ void Start(const char* configFileName)
 {
 	XASSERT(!initialized, "[XEngine] Engine already started.");
 
-	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	Platform::Initialize();
 
 	Config::StaticInitialize(configFileName);
+	Config::Get()->SetHotReload(Config::Get()->GetBool("HotReload", false));
 	
-	HINSTANCE instance = GetModuleHandleA(nullptr);
 	const char* appName = Config::Get()->GetString("AppName", "X");
 	const int clientWidth = Config::Get()->GetInt("WinWidth", 1280);
 	const int clientHeight = Config::Get()->GetInt("WinHeight", 720);
+	XVERIFY(Platform::InitializeWindow(appName, clientWidth, clientHeight), "[XEngine] Failed to create window.");
 	
-	// Every Windows Window requires at least oen window object. Three things are involved:
-	// 1)	Register a window class.
-	// 2)	Create a window object.
-	// 3)	Retrieve and dispatch messages for this window.
-
-	// Register class
-	WNDCLASSEXA wcex;
-	wcex.cbSize = sizeof(WNDCLASSEXA);
-	wcex.style = CS_HREDRAW | CS_VREDRAW;
-	wcex.lpfnWndProc = WndProc;
-	wcex.cbClsExtra = 0;
-	wcex.cbWndExtra = 0;
-	wcex.hInstance = instance;
-	wcex.hIcon = LoadIconA(nullptr, IDI_APPLICATION);
-	wcex.hCursor = LoadCursorA(nullptr, IDC_ARROW);
-	wcex.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
-	wcex.lpszMenuName = nullptr;
-	wcex.lpszClassName = appName;
-	wcex.hIconSm = LoadIconA(nullptr, IDI_APPLICATION);
-
-	XVERIFY(RegisterClassExA(&wcex), "[Window] Failed to register window class.");
-
-	// Compute the correct window dimension
-	RECT rc = { 0, 0, static_cast<LONG>(clientWidth), static_cast<LONG>(clientHeight) };
-	AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW, FALSE);
-	
-	const int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-	const int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-	const int winWidth = rc.right - rc.left;
-	const int winHeight = rc.bottom - rc.top;
-	const int left = (screenWidth - winWidth) >> 1;
-	const int top = (screenHeight - winHeight) >> 1;
-
-	// Create window
-	myWindow = CreateWindowA
-	(
-		appName,
-		appName,
-		WS_OVERLAPPEDWINDOW,
-		left,
-		top,
-		winWidth,
-		winHeight,
-		nullptr,
-		nullptr,
-		instance,
-		nullptr
-	);
-
-	XASSERT(myWindow != nullptr, "[XEngine] Failed to create window.");
-
-	ShowWindow(myWindow, true);
+#if defined(_WIN32)
+	// "Software" renders on the CPU into a framebuffer, e.g. on machines without a GPU
+	mySoftwareRendering = Platform::CompareNoCase(Config::Get()->GetString("Renderer", "D3D11"), "Software") == 0;
+#else
+	mySoftwareRendering = true;
+#endif
+
+	// The D3D11 context and ImGui belong to the game thread, only the software renderer threads
+	myThreadedRendering = Config::Get()->GetBool("ThreadedRendering", false);
+	if (myThreadedRendering && !mySoftwareRendering)
+	{
+		XLOG("[XEngine] ThreadedRendering needs the software renderer, rendering on the game thread.");
+		myThreadedRendering = false;
+	}
 
-	XVERIFY(SetCursorPos(screenWidth >> 1, screenHeight >> 1), "[Window] Failed to set cursor position.");
-	
 	// Initialize all engine systems
+	ThreadPool::StaticInitialize(Config::Get()->GetInt("LoaderThreads", 2));
+	const int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+	JobSystem::StaticInitialize(Math::Max(Config::Get()->GetInt("WorkerThreads", hardwareThreads - 1), 0));
+#if defined(_WIN32)
 	AudioSystem::StaticInitialize();
-	GraphicsSystem::StaticInitialize(myWindow, Config::Get()->GetBool("FullScreen", false));
-	InputSystem::StaticInitialize(myWindow);
-	SimpleDraw::Initialize(1024 * 1024);
-	SpriteRenderer::StaticInitialize();
+	if (!mySoftwareRendering)
+	{
+		GraphicsSystem::StaticInitialize(static_cast<HWND>(Platform::GetWindowHandle()), Config::Get()->GetBool("FullScreen", false));
+	}
+#endif
+	if (mySoftwareRendering)
+	{
+		SoftwareRenderer::StaticInitialize(clientWidth, clientHeight);
+	}
+	InputSystem::StaticInitialize();
+	SimpleDraw::Initialize(4096, !mySoftwareRendering);
+	myFrameAllocator.Initialize(kFrameArenaSize);
+	myIsGameThread = true;
+#if defined(_WIN32)
+	if (!mySoftwareRendering)
+	{
+		SpriteRenderer::StaticInitialize();
+	}
 	SoundEffectManager::StaticInitialize(Config::Get()->GetString("SoundPath", "../Assets/Sounds"));
-	TextureManager::StaticInitialize(Config::Get()->GetString("TexturePath", "../Assets/Images"));
-	Gui::Initialize(myWindow);
+#endif
+	TextureManager::StaticInitialize(Config::Get()->GetString("TexturePath", "../Assets/Images"), !mySoftwareRendering);
+	if (Config::Get()->GetBool("TextureAtlas", true))
+	{
+		const int pageSize = Config::Get()->GetInt("TextureAtlasPageSize", 1024);
+		TextureManager::Get()->EnableAtlas(static_cast<uint32_t>(pageSize), Config::Get()->GetString("TextureAtlasCache", ""));
+	}
+#if defined(_WIN32)
+	if (!mySoftwareRendering)
+	{
+		Gui::Initialize(static_cast<HWND>(Platform::GetWindowHandle()));
+	}
+#endif
+	PerfHud::Initialize(Config::Get()->GetBool("ShowPerformanceHud", false));
+	StatsRecorder::Initialize(Config::Get()->GetString("StatsFile", ""));
+
+	// Frame limiter, 0 runs as fast as possible
+	myTimer.SetTargetFrameRate(Config::Get()->GetFloat("TargetFPS", 0.0f));
+
+	// Game time, a fixed time step advances the clock by exactly that much every frame regardless of
+	// how long the frame really took
+	SetRandomSeed(static_cast<uint64_t>(Config::Get()->GetInt("RandomSeed", 0)));
+	myTimer.SetTimeScale(Config::Get()->GetFloat("TimeScale", 1.0f));
+	myFixedTimeStep = Math::Max(Config::Get()->GetFloat("FixedTimeStep", 0.0f), 0.0f);
+	myTimer.SetClock(myFixedTimeStep > 0.0f ? &myManualClock : nullptr);
 
 	// Initialize camera
 	myCamera.SetFOV(60.0f * Math::kDegToRad);
 	myCamera.SetNearPlane(0.01f);
 	myCamera.SetFarPlane(10000.0f);
 
-	// Initialize font
-	myFont.Initialize();
+	// Initialize font, the glyph atlas is baked once here for every backend
+	myFont.Initialize(Config::Get()->GetString("FontFile"), Config::Get()->GetFloat("FontSize", 13.0f));
+#if defined(_WIN32)
+	if (!mySoftwareRendering)
+	{
+		const Image& atlas = myFont.GetAtlas();
+		myFontTexture.Initialize(atlas.pixels.data(), atlas.width, atlas.height);
+	}
+#endif
 
 	// Engine initialized
 	initialized = true;
@@ -223,88 +653,113 @@ void Run(bool (*GameLoop)(float))
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
 
+	// Everything loaded during game init gets packed into atlas pages
+	TextureManager::Get()->BuildAtlas();
+
 	myTimer.Initialize();
 
-	// Start the main loop
-	bool quit = false;
-	while (!quit)
+	if (myThreadedRendering)
 	{
-		MSG msg = {};
-		while (PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
-		{
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
+		myRenderThread = std::thread(RenderThread, mySubmitCount + 1);
+	}
 
-			if (msg.message == WM_QUIT)
-				quit = true;
-		}
+	uint64_t frame = 0;
 
-		if (quit)
-			break;
+	// Start the main loop
+	while (Platform::ProcessMessages())
+	{
+		// Pick up config changes before anything reads it this frame
+		Config::Get()->Update();
 
 		// Update input and timer
 		InputSystem::Get()->Update();
+		if (myFixedTimeStep > 0.0f)
+		{
+			myManualClock.Advance(myFixedTimeStep);
+		}
 		myTimer.Update();
 
 		const float kDeltaTime = myTimer.GetElapsedTime();
 
+#if defined(_WIN32)
 		// Update audio
 		AudioSystem::Get()->Update();
+		SoundEffectManager::Get()->Update();
 
 		// Begin Gui
-		Gui::BeginRender();
+		if (!mySoftwareRendering)
+		{
+			Gui::BeginRender();
+		}
+#endif
+
+		// Finish any async loads that are done decoding
+		TextureManager::Get()->Update();
 
 		// Run game loop
+		const uint64_t allocationStart = StatsRecorder::GetAllocationCount();
+		const SteadyClock::time_point simulationStart = SteadyClock::now();
 		if (GameLoop(kDeltaTime))
 		{
-			PostQuitMessage(0);
+			Platform::PostQuit();
 		}
-
-		// Begin scene
-		GraphicsSystem::Get()->BeginRender(myBackgroundColor);
-
-		TextureId id = 0;
-		Texture* texture = nullptr;
-
-		// Sprites
-		SpriteRenderer::Get()->BeginRender();
-		for (const auto& command : mySpriteCommands)
+		const SteadyClock::time_point simulationEnd = SteadyClock::now();
+		MergeThreadSprites(*myCommands);
+
+		FrameStats stats;
+		stats.frame = frame++;
+		stats.frameTime = myTimer.GetFrameTime();
+		stats.simulationTime = ToMilliseconds(simulationEnd - simulationStart);
+		stats.spriteCommands = static_cast<uint32_t>(myCommands->sprites.size());
+		stats.textCommands = static_cast<uint32_t>(myCommands->text.size());
+		stats.vertices2D = SimpleDraw::GetVertexCount2D();
+		stats.vertices3D = SimpleDraw::GetVertexCount3D();
+#if defined(_WIN32)
+		stats.audioVoices = AudioSystem::Get()->GetPlayingVoiceCount();
+#endif
+
+		SubmitFrame(*myCommands, stats);
+		mySpriteLayer = 0;
+
+		// The render thread must be done with the previous frame before its memory is reused. Its
+		// render time is reported with this frame.
+		const uint32_t submitted = ++mySubmitCount;
+		if (myThreadedRendering)
 		{
-			if (id != command.textureId)
-			{
-				texture = TextureManager::Get()->GetTexture(command.textureId);
-				id = command.textureId;
-			}
-			if (texture)
-			{
-				if (Math::IsEmpty(command.sourceRect))
-				{
-					SpriteRenderer::Get()->Draw(*texture, command.position, command.rotation, command.pivot, command.flip);
-				}
-				else
-				{
-					SpriteRenderer::Get()->Draw(*texture, command.sourceRect, command.position, command.rotation, command.pivot, command.flip);
-				}
-			}
+			myRendered.Wait(submitted - 1);
+			stats.renderTime = myFrames[(submitted - 1) & 1].renderTime;
 		}
-		mySpriteCommands.clear();
-		SpriteRenderer::Get()->EndRender();
-
-		// Text
-		for (const auto& command : myTextCommands)
+		SimpleDraw::Flip();
+		if (myThreadedRendering)
+		{
+			mySubmitted.Signal(submitted);
+		}
+		else
 		{
-			myFont.Draw(command.str.c_str(), command.size, command.x, command.y, command.color);
+			RenderFrame(*myCommands);
+			stats.renderTime = myCommands->renderTime;
 		}
-		myTextCommands.clear();
 
-		// Render
-		SimpleDraw::Render(myCamera);
-			
-		// End Gui
-		Gui::EndRender();
+		// This frame's arena stays intact while it is rendered, the next frame records into the other
+		myFrameAllocator.Flip();
+		myCommands = &myFrames[(submitted + 1) & 1];
+		myCommands->Clear();
 
-		// End scene
-		GraphicsSystem::Get()->EndRender();
+		stats.allocations = static_cast<uint32_t>(StatsRecorder::GetAllocationCount() - allocationStart);
+
+		myFrameStats = stats;
+		PerfHud::AddSample(stats);
+		StatsRecorder::Submit(stats);
+
+		// Hold the frame until the target frame time is up
+		myTimer.WaitForNextFrame();
+	}
+
+	if (myThreadedRendering)
+	{
+		myRenderStopFrame = mySubmitCount + 1;
+		mySubmitted.Signal(mySubmitCount + 1);
+		myRenderThread.join();
 	}
 }
 
@@ -314,30 +769,45 @@ void Stop()
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
 
-	// Destroy font
+#if defined(_WIN32)
+	// Destroy font texture and gui
+	if (!mySoftwareRendering)
+	{
+		myFontTexture.Terminate();
+		Gui::Terminate();
+	}
+#endif
 	myFont.Terminate();
 
 	// Shutdown all engine systems
-	Gui::Terminate();
+	StatsRecorder::Terminate();
+	PerfHud::Terminate();
 	TextureManager::StaticTerminate();
-	SoundEffectManager::StaticTerminate();
-	SpriteRenderer::StaticTerminate();
+	myFrames[0].Clear();
+	myFrames[1].Clear();
+	myFrameAllocator.Terminate();
+	mySpriteBuffers.clear();
+	myThreadSprites.clear();
+	mySpriteBufferGeneration.fetch_add(1, std::memory_order_release);
+	myIsGameThread = false;
 	SimpleDraw::Terminate();
 	InputSystem::StaticTerminate();
+	SoftwareRenderer::StaticTerminate();
+#if defined(_WIN32)
+	SoundEffectManager::StaticTerminate();
+	SpriteRenderer::StaticTerminate();
 	GraphicsSystem::StaticTerminate();
 	AudioSystem::StaticTerminate();
+#endif
+	JobSystem::StaticTerminate();
+	ThreadPool::StaticTerminate();
 
 	// Destroy the window
-	DestroyWindow(myWindow);
-
-	// Unregister window class
-	HINSTANCE instance = GetModuleHandleA(nullptr);
-	const char* appName = Config::Get()->GetString("AppName", "X");
-	UnregisterClassA(appName, instance);
+	Platform::TerminateWindow();
 
 	Config::StaticTerminate();
 
-	CoUninitialize();
+	Platform::Terminate();
 
 	// Engine shutdown
 	initialized = false;
@@ -377,6 +847,30 @@ const char* ConfigGetString(const char* key, const char* defaultValue)
 
 //----------------------------------------------------------------------------------------------------
 
+ConfigInt ConfigFindInt(const char* key, int defaultValue)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return Config::Get()->FindInt(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigBool ConfigFindBool(const char* key, bool defaultValue)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return Config::Get()->FindBool(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ConfigFloat ConfigFindFloat(const char* key, float defaultValue)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return Config::Get()->FindFloat(key, defaultValue);
+}
+
+//----------------------------------------------------------------------------------------------------
+
 float GetTime()
 {
 	return myTimer.GetTotalTime();
@@ -384,6 +878,62 @@ float GetTime()
 
 //----------------------------------------------------------------------------------------------------
 
+void SetTimeScale(float scale)
+{
+	myTimer.SetTimeScale(Math::Max(scale, 0.0f));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float GetTimeScale()
+{
+	return myTimer.GetTimeScale();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float GetFramesPerSecond()
+{
+	return myTimer.GetFramesPerSecond();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float GetFrameTimePercentile(float percent)
+{
+	return myTimer.GetFrameTimePercentile(percent);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float GetMaxFrameTime()
+{
+	return myTimer.GetMaxFrameTime();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t GetHitchCount()
+{
+	return myTimer.GetHitchCount();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResetFrameTimeStats()
+{
+	myTimer.ResetFrameTimeStats();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SetTargetFrameRate(float framesPerSecond)
+{
+	myTimer.SetTargetFrameRate(framesPerSecond);
+}
+
+//----------------------------------------------------------------------------------------------------
+
 void SetCameraPosition(const Math::Vector3& position)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
@@ -411,7 +961,47 @@ void SetCameraTarget(const Math::Vector3& target)
 X::SoundId LoadSound(const char* fileName)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	return SoundEffectManager::Get()->Load(fileName);
+#else
+	return 0;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+X::SoundId LoadSoundAsync(const char* fileName)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
+	return SoundEffectManager::Get()->LoadAsync(fileName);
+#else
+	return 0;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsSoundReady(SoundId soundId)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
+	return SoundEffectManager::Get()->IsReady(soundId);
+#else
+	return true;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsSoundLoading(SoundId soundId)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
+	return SoundEffectManager::Get()->IsLoading(soundId);
+#else
+	return false;
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -419,7 +1009,9 @@ X::SoundId LoadSound(const char* fileName)
 void ClearAllSounds()
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	return SoundEffectManager::Get()->Clear();
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -432,38 +1024,51 @@ X::TextureId LoadTexture(const char* fileName)
 
 //----------------------------------------------------------------------------------------------------
 
+X::TextureId LoadTextureAsync(const char* fileName)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return TextureManager::Get()->LoadAsync(fileName);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsTextureReady(TextureId textureId)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return TextureManager::Get()->IsReady(textureId);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsTextureLoading(TextureId textureId)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return TextureManager::Get()->IsLoading(textureId);
+}
+
+//----------------------------------------------------------------------------------------------------
+
 void ClearAllTextures()
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
-	return TextureManager::Get()->Clear();
+
+	// Submitted frames draw straight from the texture manager's images
+	WaitForRenderThread();
+	TextureManager::Get()->Clear();
 }
 
 //----------------------------------------------------------------------------------------------------
 
-bool OpenFileDialog(char fileName[MAX_PATH], const char* title, const char* filter)
+bool OpenFileDialog(char fileName[Platform::kMaxPath], const char* title, const char* filter)
 {
-	OPENFILENAMEA ofn = {};
-	ofn.lStructSize = sizeof(ofn);
-	ofn.hwndOwner = myWindow;
-	ofn.lpstrFilter = filter;
-	ofn.lpstrFile = fileName;
-	ofn.nMaxFile = MAX_PATH;
-	ofn.lpstrTitle = title;
-	return GetOpenFileNameA(&ofn);
+	return Platform::OpenFileDialog(fileName, title, filter);
 }
 
 //----------------------------------------------------------------------------------------------------
 
-bool SaveFileDialog(char fileName[MAX_PATH], const char* title, const char* filter)
+bool SaveFileDialog(char fileName[Platform::kMaxPath], const char* title, const char* filter)
 {
-	OPENFILENAMEA ofn = {};
-	ofn.lStructSize = sizeof(ofn);
-	ofn.hwndOwner = myWindow;
-	ofn.lpstrFilter = filter;
-	ofn.lpstrFile = fileName;
-	ofn.nMaxFile = MAX_PATH;
-	ofn.lpstrTitle = title;
-	return GetSaveFileNameA(&ofn);
+	return Platform::SaveFileDialog(fileName, title, filter);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -471,7 +1076,9 @@ bool SaveFileDialog(char fileName[MAX_PATH], const char* title, const char* filt
 void PlaySoundOneShot(SoundId soundId)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	SoundEffectManager::Get()->Play(soundId);
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -479,7 +1086,9 @@ void PlaySoundOneShot(SoundId soundId)
 void PlaySoundLoop(SoundId soundId)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	SoundEffectManager::Get()->Play(soundId, true);
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -487,7 +1096,11 @@ void PlaySoundLoop(SoundId soundId)
 bool IsSoundPlaying(SoundId soundId)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	return SoundEffectManager::Get()->IsPlaying(soundId);
+#else
+	return false;
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -495,7 +1108,9 @@ bool IsSoundPlaying(SoundId soundId)
 void StopSoundLoop(SoundId soundId)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
+#if defined(_WIN32)
 	SoundEffectManager::Get()->Stop(soundId);
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -509,10 +1124,9 @@ void SetBackgroundColor(const Color& color)
 
 void Zoom(float zoom)
 {
+	// Sprites pick the zoom up when the frame is submitted
 	myZoom = zoom;
-	auto transform = Math::Matrix4::Scaling(zoom);
-	SimpleDraw::SetTransform(transform);
-	SpriteRenderer::Get()->SetTransform(transform);
+	SimpleDraw::SetTransform(Math::Matrix4::Scaling(zoom));
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -648,8 +1262,67 @@ void DrawScreenDiamond(float x, float y, float size, const Color& color)
 void DrawScreenText(const char* str, float x, float y, float size, const Color& color)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
-	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-	myTextCommands.emplace_back(converter.from_bytes(str), size, x, y, ToColor(color));
+	const uint32_t length = static_cast<uint32_t>(strlen(str));
+	const uint32_t offset = static_cast<uint32_t>(myCommands->textBytes.size());
+	memcpy(myCommands->textBytes.append(length), str, length);
+	myCommands->text.emplace_back(offset, length, size, x, y, ToColor(color));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ShowPerformanceHud(bool show)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	PerfHud::SetVisible(show);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsPerformanceHudVisible()
+{
+	return PerfHud::IsVisible();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const FrameStats& GetFrameStats()
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return myFrameStats;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void MarkFrameEvent(const char* name)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	XASSERT(myIsGameThread, "[XEngine] Frame events can only be marked from the game thread.");
+	StatsRecorder::MarkEvent(name);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SetPerformanceCounter(const char* name, int value)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	PerfHud::SetCounter(name, value);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SetSpriteLayer(uint8_t layer)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	if (DrawsDirectly())
+	{
+		mySpriteLayer = layer;
+	}
+	else
+	{
+		ThreadSpriteBuffer& buffer = GetThreadSpriteBuffer();
+		buffer.layer = layer;
+		buffer.layerJob = JobSystem::GetCurrentJob();
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -657,7 +1330,14 @@ void DrawScreenText(const char* str, float x, float y, float size, const Color&
 void DrawSprite(TextureId textureId, const Math::Vector2& position, Pivot pivot, Flip flip)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
-	mySpriteCommands.emplace_back(textureId, position, 0.0f, pivot, flip);
+	if (DrawsDirectly())
+	{
+		AddSprite(textureId, 0, position, 0.0f, pivot, flip);
+	}
+	else
+	{
+		AddThreadSprite(textureId, nullptr, position, 0.0f, pivot, flip);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -665,7 +1345,14 @@ void DrawSprite(TextureId textureId, const Math::Vector2& position, Pivot pivot,
 void DrawSprite(TextureId textureId, const Math::Vector2& position, float rotation, Pivot pivot, Flip flip)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
-	mySpriteCommands.emplace_back(textureId, position, rotation, pivot, flip);
+	if (DrawsDirectly())
+	{
+		AddSprite(textureId, 0, position, rotation, pivot, flip);
+	}
+	else
+	{
+		AddThreadSprite(textureId, nullptr, position, rotation, pivot, flip);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -673,73 +1360,177 @@ void DrawSprite(TextureId textureId, const Math::Vector2& position, float rotati
 void DrawSprite(TextureId textureId, const Math::Rect& sourceRect, const Math::Vector2& position)
 {
 	XASSERT(initialized, "[XEngine] Engine not started.");
-	mySpriteCommands.emplace_back(textureId, sourceRect, position, 0.0f);
+	if (DrawsDirectly())
+	{
+		myCommands->spriteRects.push_back(sourceRect);
+		AddSprite(textureId, static_cast<uint32_t>(myCommands->spriteRects.size()), position, 0.0f, Pivot::Center, Flip::None);
+	}
+	else
+	{
+		AddThreadSprite(textureId, &sourceRect, position, 0.0f, Pivot::Center, Flip::None);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------
 
 uint32_t GetSpriteWidth(TextureId textureId)
 {
-	Texture* texture = TextureManager::Get()->GetTexture(textureId);
-	return texture ? texture->GetWidth() : 0u;
+	const TextureManager::Region* region = TextureManager::Get()->GetRegion(textureId);
+	return region ? region->width : 0u;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 uint32_t GetSpriteHeight(TextureId textureId)
 {
-	Texture* texture = TextureManager::Get()->GetTexture(textureId);
-	return texture ? texture->GetHeight() : 0u;
+	const TextureManager::Region* region = TextureManager::Get()->GetRegion(textureId);
+	return region ? region->height : 0u;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void* GetSprite(TextureId textureId)
 {
+#if defined(_WIN32)
 	Texture* texture = TextureManager::Get()->GetTexture(textureId);
 	return texture ? texture->GetShaderResourceView() : nullptr;
+#else
+	return nullptr;
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
 
 uint32_t GetScreenWidth()
 {
-	return GraphicsSystem::Get()->GetWidth();
+#if defined(_WIN32)
+	return mySoftwareRendering ? SoftwareRenderer::Get()->GetWidth() : GraphicsSystem::Get()->GetWidth();
+#else
+	return SoftwareRenderer::Get()->GetWidth();
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
 
 uint32_t GetScreenHeight()
 {
-	return GraphicsSystem::Get()->GetHeight();
+#if defined(_WIN32)
+	return mySoftwareRendering ? SoftwareRenderer::Get()->GetHeight() : GraphicsSystem::Get()->GetHeight();
+#else
+	return SoftwareRenderer::Get()->GetHeight();
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IsSoftwareRendering()
+{
+	return mySoftwareRendering;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SaveFrame(const char* fileName)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	if (!mySoftwareRendering)
+	{
+		XLOG("[XEngine] SaveFrame needs Config \"Renderer\" set to \"Software\".");
+		return;
+	}
+	myCommands->captureName = fileName;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RunJob(JobFunction function, void* data, JobCounter& counter)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	JobSystem::Get()->Run(function, data, counter);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RunJobAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter& counter)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	JobSystem::Get()->RunAfter(dependency, function, data, counter);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void WaitForJobs(JobCounter& counter)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	JobSystem::Get()->Wait(counter);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t GetWorkerThreadCount()
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	return JobSystem::Get()->GetWorkerCount();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ParallelFor(uint32_t count, uint32_t grainSize, JobRangeFunction function, void* data)
+{
+	XASSERT(initialized, "[XEngine] Engine not started.");
+	JobSystem::Get()->ParallelFor(count, grainSize, function, data);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SetRandomSeed(uint64_t seed)
+{
+	if (seed == 0)
+	{
+		seed = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ Platform::GetClockTicks();
+	}
+	myRandomSeed = seed;
+	myRandomStreamCount = 0;
+	myRandomGeneration.fetch_add(1, std::memory_order_release);
+
+	// The calling thread takes stream 0
+	GetThreadRandomStream();
+	XLOG("[XEngine] Random seed %llu.", static_cast<unsigned long long>(seed));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint64_t GetRandomSeed()
+{
+	return myRandomSeed;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 int Random()
 {
-	return std::uniform_int_distribution<>{ 0, (std::numeric_limits<int>::max)() }(myRandomEngine);
+	return static_cast<int>(GetThreadRandomStream().Next() >> 1);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 int Random(int min, int max)
 {
-	return std::uniform_int_distribution<>{ min, max }(myRandomEngine);
+	return GetThreadRandomStream().Range(min, max);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float RandomFloat()
 {
-	return std::uniform_real_distribution<float>{ 0, 1.0f }(myRandomEngine);
+	return GetThreadRandomStream().NextFloat();
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float RandomFloat(float min, float max)
 {
-	return std::uniform_real_distribution<float>{ min, max }(myRandomEngine);
+	return GetThreadRandomStream().Range(min, max);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -937,9 +1728,7 @@ Math::Ray GetMouseRay()
 
 Math::Ray GetScreenRay(int screenX, int screenY)
 {
-	const uint32_t screenWidth = GraphicsSystem::Get()->GetWidth();
-	const uint32_t screenHeight = GraphicsSystem::Get()->GetHeight();
-	return myCamera.ScreenPointToRay(screenX, screenY, screenWidth, screenHeight);
+	return myCamera.ScreenPointToRay(screenX, screenY, GetScreenWidth(), GetScreenHeight());
 }
 
 //----------------------------------------------------------------------------------------------------
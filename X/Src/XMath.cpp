@@ -325,6 +325,246 @@ bool X::Math::Intersect(const Rect& r, const Circle& c)
 
 //----------------------------------------------------------------------------------------------------
 
+namespace
+{
+	static_assert(sizeof(Rect) == 4 * sizeof(float) && sizeof(LineSegment) == 4 * sizeof(float), "Batched tests load these as four floats");
+	static_assert(sizeof(Circle) == 3 * sizeof(float), "Batched tests load circles as three floats");
+
+	const uint8_t kBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+	void ClearHitMask(uint32_t* hitMask, uint32_t count)
+	{
+		memset(hitMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+	}
+
+	// Bits for candidates index onwards, never more than four so a group stays within one word
+	uint32_t AddHits(uint32_t* hitMask, uint32_t index, uint32_t bits)
+	{
+		hitMask[index / 32] |= bits << (index % 32);
+		return kBitCount[bits];
+	}
+
+	// Same math as the four wide version, zero length segments test their start point
+	bool IntersectClamped(const Circle& c, const LineSegment& l)
+	{
+		const Vector2 d = l.to - l.from;
+		const float t = Clamp(Dot(c.center - l.from, d) / Max(Dot(d, d), 1e-12f), 0.0f, 1.0f);
+		const Vector2 point = l.from + (d * t);
+		return DistanceSqr(point, c.center) < c.radius * c.radius;
+	}
+
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	// Four rects or line segments, one register per field
+	void Load4(const float* p, Simd::Float4& a, Simd::Float4& b, Simd::Float4& c, Simd::Float4& d)
+	{
+		a = Simd::Load(p);
+		b = Simd::Load(p + 4);
+		c = Simd::Load(p + 8);
+		d = Simd::Load(p + 12);
+		Simd::Transpose(a, b, c, d);
+	}
+
+	// Four circles packed as x, y, radius. The last load is shifted back so it stays inside the array.
+	void Load3(const float* p, Simd::Float4& x, Simd::Float4& y, Simd::Float4& r)
+	{
+		Simd::Float4 a = Simd::Load(p);
+		Simd::Float4 b = Simd::Load(p + 3);
+		Simd::Float4 c = Simd::Load(p + 6);
+		Simd::Float4 d = Simd::Rotate(Simd::Load(p + 8));
+		Simd::Transpose(a, b, c, d);
+		x = a;
+		y = b;
+		r = c;
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t X::Math::Intersect(const LineSegment& probe, const LineSegment* segments, uint32_t count, uint32_t* hitMask)
+{
+	ClearHitMask(hitMask, count);
+	uint32_t hits = 0;
+	uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	const Simd::Float4 zero = Simd::Splat(0.0f);
+	const Simd::Float4 one = Simd::Splat(1.0f);
+	const Simd::Float4 ax = Simd::Splat(probe.from.x);
+	const Simd::Float4 ay = Simd::Splat(probe.from.y);
+	const Simd::Float4 adx = Simd::Splat(probe.to.x - probe.from.x);
+	const Simd::Float4 ady = Simd::Splat(probe.to.y - probe.from.y);
+	for (; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 bx, by, btx, bty;
+		Load4(&segments[i].from.x, bx, by, btx, bty);
+		const Simd::Float4 bdx = Simd::Sub(btx, bx);
+		const Simd::Float4 bdy = Simd::Sub(bty, by);
+		const Simd::Float4 ox = Simd::Sub(bx, ax);
+		const Simd::Float4 oy = Simd::Sub(by, ay);
+		const Simd::Float4 ua = Simd::Sub(Simd::Mul(adx, oy), Simd::Mul(ady, ox));
+		const Simd::Float4 ub = Simd::Sub(Simd::Mul(bdx, oy), Simd::Mul(bdy, ox));
+		const Simd::Float4 denom = Simd::Sub(Simd::Mul(ady, bdx), Simd::Mul(adx, bdy));
+
+		// Parallel segments only hit when they are the same line
+		const Simd::Mask4 parallel = Simd::Equal(denom, zero);
+		const Simd::Mask4 same = Simd::And(parallel, Simd::And(Simd::Equal(ua, zero), Simd::Equal(ub, zero)));
+		const Simd::Float4 ta = Simd::Div(ua, denom);
+		const Simd::Float4 tb = Simd::Div(ub, denom);
+		const Simd::Mask4 inRange = Simd::And(
+			Simd::And(Simd::LessEqual(zero, ta), Simd::LessEqual(ta, one)),
+			Simd::And(Simd::LessEqual(zero, tb), Simd::LessEqual(tb, one)));
+		hits += AddHits(hitMask, i, Simd::MoveMask(Simd::Or(same, Simd::AndNot(inRange, parallel))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		if (Intersect(probe, segments[i]))
+		{
+			hits += AddHits(hitMask, i, 1);
+		}
+	}
+	return hits;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t X::Math::Intersect(const Circle& probe, const Circle* circles, uint32_t count, uint32_t* hitMask)
+{
+	ClearHitMask(hitMask, count);
+	uint32_t hits = 0;
+	uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	const Simd::Float4 px = Simd::Splat(probe.center.x);
+	const Simd::Float4 py = Simd::Splat(probe.center.y);
+	const Simd::Float4 pr = Simd::Splat(probe.radius);
+	for (; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 x, y, r;
+		Load3(&circles[i].center.x, x, y, r);
+		const Simd::Float4 dx = Simd::Sub(x, px);
+		const Simd::Float4 dy = Simd::Sub(y, py);
+		const Simd::Float4 radii = Simd::Add(r, pr);
+		const Simd::Float4 distSqr = Simd::MulAdd(dx, dx, Simd::Mul(dy, dy));
+		hits += AddHits(hitMask, i, Simd::MoveMask(Simd::Less(distSqr, Simd::Mul(radii, radii))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		if (Intersect(probe, circles[i]))
+		{
+			hits += AddHits(hitMask, i, 1);
+		}
+	}
+	return hits;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t X::Math::Intersect(const Rect& probe, const Rect* rects, uint32_t count, uint32_t* hitMask)
+{
+	ClearHitMask(hitMask, count);
+	uint32_t hits = 0;
+	uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	const Simd::Float4 pl = Simd::Splat(probe.left);
+	const Simd::Float4 pt = Simd::Splat(probe.top);
+	const Simd::Float4 pr = Simd::Splat(probe.right);
+	const Simd::Float4 pb = Simd::Splat(probe.bottom);
+	for (; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 l, t, r, b;
+		Load4(&rects[i].left, l, t, r, b);
+		const Simd::Mask4 hit = Simd::And(
+			Simd::And(Simd::LessEqual(pl, r), Simd::LessEqual(pt, b)),
+			Simd::And(Simd::LessEqual(l, pr), Simd::LessEqual(t, pb)));
+		hits += AddHits(hitMask, i, Simd::MoveMask(hit));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		if (Intersect(probe, rects[i]))
+		{
+			hits += AddHits(hitMask, i, 1);
+		}
+	}
+	return hits;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t X::Math::Intersect(const Circle& probe, const LineSegment* segments, uint32_t count, uint32_t* hitMask)
+{
+	ClearHitMask(hitMask, count);
+	uint32_t hits = 0;
+	uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	const Simd::Float4 zero = Simd::Splat(0.0f);
+	const Simd::Float4 one = Simd::Splat(1.0f);
+	const Simd::Float4 epsilon = Simd::Splat(1e-12f);
+	const Simd::Float4 cx = Simd::Splat(probe.center.x);
+	const Simd::Float4 cy = Simd::Splat(probe.center.y);
+	const Simd::Float4 radiusSqr = Simd::Splat(probe.radius * probe.radius);
+	for (; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 fx, fy, tx, ty;
+		Load4(&segments[i].from.x, fx, fy, tx, ty);
+		const Simd::Float4 dx = Simd::Sub(tx, fx);
+		const Simd::Float4 dy = Simd::Sub(ty, fy);
+		const Simd::Float4 wx = Simd::Sub(cx, fx);
+		const Simd::Float4 wy = Simd::Sub(cy, fy);
+
+		// Closest point on each segment to the center
+		const Simd::Float4 lengthSqr = Simd::Max(Simd::MulAdd(dx, dx, Simd::Mul(dy, dy)), epsilon);
+		const Simd::Float4 t = Simd::Max(zero, Simd::Min(Simd::Div(Simd::MulAdd(wx, dx, Simd::Mul(wy, dy)), lengthSqr), one));
+		const Simd::Float4 ex = Simd::Sub(Simd::MulAdd(dx, t, fx), cx);
+		const Simd::Float4 ey = Simd::Sub(Simd::MulAdd(dy, t, fy), cy);
+		const Simd::Float4 distSqr = Simd::MulAdd(ex, ex, Simd::Mul(ey, ey));
+		hits += AddHits(hitMask, i, Simd::MoveMask(Simd::Less(distSqr, radiusSqr)));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		if (IntersectClamped(probe, segments[i]))
+		{
+			hits += AddHits(hitMask, i, 1);
+		}
+	}
+	return hits;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t X::Math::Intersect(const Circle& probe, const Rect* rects, uint32_t count, uint32_t* hitMask)
+{
+	ClearHitMask(hitMask, count);
+	uint32_t hits = 0;
+	uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+	const Simd::Float4 cx = Simd::Splat(probe.center.x);
+	const Simd::Float4 cy = Simd::Splat(probe.center.y);
+	const Simd::Float4 radiusSqr = Simd::Splat(probe.radius * probe.radius);
+	for (; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 l, t, r, b;
+		Load4(&rects[i].left, l, t, r, b);
+		const Simd::Float4 dx = Simd::Sub(Simd::Max(l, Simd::Min(r, cx)), cx);
+		const Simd::Float4 dy = Simd::Sub(Simd::Max(t, Simd::Min(b, cy)), cy);
+		const Simd::Float4 distSqr = Simd::MulAdd(dx, dx, Simd::Mul(dy, dy));
+		hits += AddHits(hitMask, i, Simd::MoveMask(Simd::LessEqual(distSqr, radiusSqr)));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		if (Intersect(probe, rects[i]))
+		{
+			hits += AddHits(hitMask, i, 1);
+		}
+	}
+	return hits;
+}
+
+//----------------------------------------------------------------------------------------------------
+
 bool X::Math::Intersect(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& distance)
 {
 	// Reference: https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
@@ -643,4 +883,92 @@ Vector3 X::Math::Mean(const Vector3* v, uint32_t count)
 		mean += v[i];
 	}
 	return mean / (float)count;
-}
\ No newline at end of file
+}
+//----------------------------------------------------------------------------------------------------
+
+Matrix4 X::Math::InverseAffine(const Matrix4& m)
+{
+	// The upper 3x3 inverse is the transposed cofactors, which for rows a, b, c are the cross products
+	// of the other two rows. The translation is then pulled back through that inverse.
+	const Vector3 a(m._11, m._12, m._13);
+	const Vector3 b(m._21, m._22, m._23);
+	const Vector3 c(m._31, m._32, m._33);
+	const Vector3 bc = Cross(b, c);
+	const Vector3 ca = Cross(c, a);
+	const Vector3 ab = Cross(a, b);
+	const float invDet = 1.0f / Dot(a, bc);
+
+	Matrix4 inv
+	(
+		bc.x * invDet, ca.x * invDet, ab.x * invDet, 0.0f,
+		bc.y * invDet, ca.y * invDet, ab.y * invDet, 0.0f,
+		bc.z * invDet, ca.z * invDet, ab.z * invDet, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+	inv._41 = -(m._41 * inv._11 + m._42 * inv._21 + m._43 * inv._31);
+	inv._42 = -(m._41 * inv._12 + m._42 * inv._22 + m._43 * inv._32);
+	inv._43 = -(m._41 * inv._13 + m._42 * inv._23 + m._43 * inv._33);
+	return inv;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+namespace
+{
+	// Shared by the Vector2 batch transforms, out = in.x * r0 + in.y * r1 + t
+	void TransformVector2s(const Vector2* in, Vector2* out, uint32_t count, const float r0[2], const float r1[2], const float t[2])
+	{
+		uint32_t i = 0;
+#if defined(XMATH_SSE) || defined(XMATH_NEON)
+		// Two points per register, the pair is loaded before anything is stored so in place works
+		const float row0[4] = { r0[0], r0[1], r0[0], r0[1] };
+		const float row1[4] = { r1[0], r1[1], r1[0], r1[1] };
+		const float trans[4] = { t[0], t[1], t[0], t[1] };
+		const Simd::Float4 vr0 = Simd::Load(row0);
+		const Simd::Float4 vr1 = Simd::Load(row1);
+		const Simd::Float4 vt = Simd::Load(trans);
+		for (; i + 2 <= count; i += 2)
+		{
+			Simd::Float4 x, y;
+			Simd::SplitPairs(Simd::Load(&in[i].x), x, y);
+			Simd::Store(&out[i].x, Simd::MulAdd(x, vr0, Simd::MulAdd(y, vr1, vt)));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const Vector2 v = in[i];
+			out[i].x = v.x * r0[0] + v.y * r1[0] + t[0];
+			out[i].y = v.x * r0[1] + v.y * r1[1] + t[1];
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void X::Math::TransformCoord(const Vector2* in, Vector2* out, uint32_t count, const Matrix3& m)
+{
+	TransformVector2s(in, out, count, &m._11, &m._21, &m._31);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void X::Math::TransformCoord(const Vector2* in, Vector2* out, uint32_t count, const Matrix4& m)
+{
+	TransformVector2s(in, out, count, &m._11, &m._21, &m._41);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void X::Math::TransformNormal(const Vector2* in, Vector2* out, uint32_t count, const Matrix3& m)
+{
+	const float zero[2] = { 0.0f, 0.0f };
+	TransformVector2s(in, out, count, &m._11, &m._21, zero);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void X::Math::TransformNormal(const Vector2* in, Vector2* out, uint32_t count, const Matrix4& m)
+{
+	const float zero[2] = { 0.0f, 0.0f };
+	TransformVector2s(in, out, count, &m._11, &m._21, zero);
+}